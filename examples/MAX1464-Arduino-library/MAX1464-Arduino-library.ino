@@ -29,6 +29,8 @@
  * - `RELEASECPU`
  * - `RP N` read CPU port number `N` (0-15)
  * - `STEP` single step the CPU, useful for debugging
+ * - `STATS` print the performance counters (only if `MAX1464_STATS` is
+ *    defined in MAX1464Core.h)
  * - `!ERASEFLASHMEMORY!` (both partitions)
  * - `!WRITEFLASHMEMORY!` enter firmware flashing mode. From now on, only HEX
  *    lines are expected from the serial port. You can then send a whole HEX
@@ -39,6 +41,7 @@
  */
 
 #include "MAX1464.h"
+#include "MAX1464Helpers.h"
 
 // for software SPI
 //#include "MAX1464_SS.h"
@@ -59,6 +62,9 @@ unsigned long hexLinesWritten = 0; // count hex lines written during flash loop
 MAX1464 max1464(SPI_SLAVESELECT);
 //MAX1464_SS max1464(SPI_SLAVESELECT); // for software SPI
 
+FlashProgrammer programmer(max1464); // non-blocking flash programming
+IntelHexParser hexParser;
+
 void printIden() {
     Serial.println("Arduino MAX1464 Serial Terminal");
 }
@@ -91,26 +97,42 @@ void serialEvent() {
 }
 
 void loop() {
+    programmer.poll();
+
     if(!stringComplete)
         return;
 
     if(writingToFlash) {
+        hexParser.reset();
         if(String("!ABORTWRITEFLASHMEMORY!").equals(inputString)) {
             writingToFlash = false;
             Serial.println("\nAbort writing to flash memory...");
         }
-        else if(!max1464.writeHexLineToFlashMemory(inputString)) {
-            Serial.print("\nIllegal line ");
+        else if(hexParser.feed(inputString.c_str(), inputString.length())
+                != IntelHexParser::HEX_RECORD_READY) {
+            Serial.print("\nIllegal line (error ");
+            Serial.print(hexParser.status());
+            if(hexParser.status() == IntelHexParser::HEX_ERR_LENGTH) {
+                Serial.print(", more than ");
+                Serial.print(MAX1464_HEX_MAX_DATA);
+                Serial.print(" data bytes");
+            }
+            Serial.print(") ");
             Serial.println(inputString);
         }
         else {
+            // the next line keeps being received while bytes are programmed
+            while(!programmer.feed(hexParser))
+                programmer.poll();
             Serial.print(".");
             hexLinesWritten++;
             if(hexLinesWritten>80) {
                 hexLinesWritten = 0;
                 Serial.println();
             }
-            if(max1464.hasEOFBeenReached()) {
+            if(programmer.hasEOFBeenReached()) {
+                while(!programmer.isIdle())
+                    programmer.poll();
                 writingToFlash = false;
                 Serial.println();
             }
@@ -161,6 +183,11 @@ void loop() {
         Serial.println("Releasing CPU");
         max1464.releaseCpu();
     }
+#ifdef MAX1464_STATS
+    else if(String("STATS").startsWith(inputString)) {
+        max1464.stats().print(Serial);
+    }
+#endif
     else if(String("!ERASEFLASHMEMORY!").equals(inputString)) {
         Serial.println("Erasing FLASH memory");
         max1464.eraseFlashMemory();
@@ -171,9 +198,11 @@ void loop() {
         if(partition_cp != NULL) {
             partition = atoi(partition_cp);
         }
+        while(!programmer.isIdle())
+            programmer.poll();
         writingToFlash = true;
         hexLinesWritten = 0;
-        max1464.beginWritingToFlashPartition((FLASH_PARTITION)partition);
+        programmer.begin((FLASH_PARTITION)partition);
         Serial.println("Writing to flash memory...");
     }
     else {
@@ -0,0 +1,325 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include <stdio.h>
+#include <ctype.h>
+#include <vector>
+#include <algorithm>
+#include "HostArduino.h"
+
+HardwareSerial Serial;
+
+static uint8_t pinLatch[HOST_NUM_PINS];
+static uint8_t pinModes[HOST_NUM_PINS];
+static int8_t pinExternal[HOST_NUM_PINS] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+static unsigned long long virtualMicros = 0;
+static unsigned long pinModeChanges = 0;
+static unsigned long pinModeCalls = 0;
+static unsigned long digitalWrites = 0;
+static unsigned long digitalReads = 0;
+static std::string *serialSink = NULL;
+static std::string serialInput;
+
+// function-local so that it is usable from static constructors
+static std::vector<HostPinListener *> &listeners()
+{
+    static std::vector<HostPinListener *> l;
+    return l;
+}
+
+
+
+// pins
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    pinModeCalls++;
+    if(pin >= HOST_NUM_PINS)
+        return;
+    if(pinModes[pin] != mode)
+        pinModeChanges++;
+    pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    digitalWrites++;
+    hostSetPin(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+    digitalReads++;
+    return hostReadPin(pin);
+}
+
+void hostSetPin(const uint8_t pin, uint8_t val)
+{
+    if(pin >= HOST_NUM_PINS)
+        return;
+    val = val ? HIGH : LOW;
+    if(pinLatch[pin] == val)
+        return;
+    pinLatch[pin] = val;
+    std::vector<HostPinListener *> &l = listeners();
+    for(size_t i = 0; i < l.size(); i++)
+        l[i]->pinChanged(pin, val);
+}
+
+int hostReadPin(const uint8_t pin)
+{
+    if(pin >= HOST_NUM_PINS)
+        return LOW;
+    if(pinModes[pin] != OUTPUT && pinExternal[pin] >= 0)
+        return pinExternal[pin];
+    return pinLatch[pin];
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder,
+              uint8_t val)
+{
+    for(uint8_t i = 0; i < 8; i++) {
+        if(bitOrder == LSBFIRST)
+            digitalWrite(dataPin, !!(val & (1 << i)));
+        else
+            digitalWrite(dataPin, !!(val & (1 << (7 - i))));
+        digitalWrite(clockPin, HIGH);
+        digitalWrite(clockPin, LOW);
+    }
+}
+
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder)
+{
+    uint8_t value = 0;
+    for(uint8_t i = 0; i < 8; ++i) {
+        digitalWrite(clockPin, HIGH);
+        if(bitOrder == LSBFIRST)
+            value |= digitalRead(dataPin) << i;
+        else
+            value |= digitalRead(dataPin) << (7 - i);
+        digitalWrite(clockPin, LOW);
+    }
+    return value;
+}
+
+void hostAttachPinListener(HostPinListener *listener)
+{
+    listeners().push_back(listener);
+}
+
+void hostDetachPinListener(HostPinListener *listener)
+{
+    std::vector<HostPinListener *> &l = listeners();
+    l.erase(std::remove(l.begin(), l.end(), listener), l.end());
+}
+
+void hostDrivePin(const uint8_t pin, const int level)
+{
+    if(pin >= HOST_NUM_PINS)
+        return;
+    pinExternal[pin] = level < 0 ? -1 : (level ? HIGH : LOW);
+}
+
+uint8_t hostPinLatch(const uint8_t pin)
+{
+    return pin < HOST_NUM_PINS ? pinLatch[pin] : LOW;
+}
+
+uint8_t hostPinMode(const uint8_t pin)
+{
+    return pin < HOST_NUM_PINS ? pinModes[pin] : INPUT;
+}
+
+unsigned long hostPinModeChanges()
+{
+    return pinModeChanges;
+}
+
+unsigned long hostPinModeCalls()
+{
+    return pinModeCalls;
+}
+
+unsigned long hostDigitalWrites()
+{
+    return digitalWrites;
+}
+
+unsigned long hostDigitalReads()
+{
+    return digitalReads;
+}
+
+
+
+// time
+
+unsigned long millis()
+{
+    return virtualMicros / 1000;
+}
+
+unsigned long micros()
+{
+    return virtualMicros;
+}
+
+void delay(unsigned long ms)
+{
+    virtualMicros += ms * 1000ULL;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    virtualMicros += us;
+}
+
+unsigned long long hostMicros()
+{
+    return virtualMicros;
+}
+
+void hostAdvanceMicros(const unsigned long long us)
+{
+    virtualMicros += us;
+}
+
+void hostResetClock()
+{
+    virtualMicros = 0;
+}
+
+
+
+// String
+
+void String::toUpperCase()
+{
+    for(size_t i = 0; i < s.length(); i++)
+        s[i] = toupper((unsigned char)s[i]);
+}
+
+
+
+// Print
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while(size--)
+        n += write(*buffer++);
+    return n;
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char *str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if(base < 2)
+        base = 10;
+    do {
+        char c = n % base;
+        n /= base;
+        *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
+    return write(str);
+}
+
+size_t Print::print(long n, int base)
+{
+    if(base == 0)
+        return write((uint8_t)n);
+    if(base == 10 && n < 0)
+        return print('-') + printNumber(-n, 10);
+    return printNumber(n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    if(base == 0)
+        return write((uint8_t)n);
+    return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write(buf);
+}
+
+
+
+// Serial
+
+int HardwareSerial::available()
+{
+    return serialInput.length();
+}
+
+int HardwareSerial::read()
+{
+    if(serialInput.empty())
+        return -1;
+    int c = (unsigned char)serialInput[0];
+    serialInput.erase(0, 1);
+    return c;
+}
+
+int HardwareSerial::peek()
+{
+    return serialInput.empty() ? -1 : (unsigned char)serialInput[0];
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if(serialSink)
+        *serialSink += (char)c;
+    else
+        fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if(serialSink)
+        serialSink->append((const char *)buffer, size);
+    else
+        fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+void hostCaptureSerial(std::string *sink)
+{
+    serialSink = sink;
+}
+
+void hostFeedSerial(const char *data)
+{
+    serialInput += data;
+}
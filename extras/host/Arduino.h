@@ -0,0 +1,190 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Minimal host-side replacement for the Arduino core.
+ *
+ * Only the subset of the Arduino API used by the library is provided. Pins
+ * are simulated in memory (see HostArduino.h) and time is virtual: delay()
+ * and delayMicroseconds() advance the clock returned by micros() and
+ * millis() instead of sleeping.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define F_CPU 16000000UL  // as on an Arduino Uno
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder,
+              uint8_t val);
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder);
+
+
+class String
+{
+public:
+    String(const char *cstr = "") : s(cstr ? cstr : "") {}
+    String(const std::string &str) : s(str) {}
+
+    unsigned int length() const { return s.length(); }
+    const char *c_str() const { return s.c_str(); }
+    char charAt(unsigned int index) const {
+        return index < s.length() ? s[index] : 0;
+    }
+    String substring(unsigned int from) const {
+        return substring(from, s.length());
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if(from > s.length())
+            return String();
+        if(to > s.length())
+            to = s.length();
+        return String(s.substr(from, to - from));
+    }
+    unsigned char reserve(unsigned int size) { s.reserve(size); return 1; }
+    unsigned char equals(const String &other) const { return s == other.s; }
+    unsigned char startsWith(const String &prefix) const {
+        return s.compare(0, prefix.s.length(), prefix.s) == 0;
+    }
+    void toUpperCase();
+
+    String &operator+=(const char c) { s += c; return *this; }
+    String &operator+=(const char *cstr) { s += cstr; return *this; }
+    String &operator+=(const String &str) { s += str.s; return *this; }
+    bool operator==(const String &other) const { return s == other.s; }
+    bool operator!=(const String &other) const { return s != other.s; }
+
+private:
+    std::string s;
+};
+
+
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) {
+        return write((const uint8_t *)str, strlen(str));
+    }
+    size_t write(const char *buffer, size_t size) {
+        return write((const uint8_t *)buffer, size);
+    }
+
+    size_t print(const char str[]) { return write(str); }
+    size_t print(const String &str) { return write(str.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T &value) {
+        size_t n = print(value);
+        return n + println();
+    }
+    template <typename T> size_t println(const T &value, int format) {
+        size_t n = print(value, format);
+        return n + println();
+    }
+
+private:
+    size_t printNumber(unsigned long n, uint8_t base);
+};
+
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+
+/**
+ * @brief Serial port replacement.
+ *
+ * Output goes to stdout unless redirected with hostCaptureSerial(); input is
+ * taken from a buffer filled by hostFeedSerial().
+ */
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
@@ -0,0 +1,106 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Host-only controls for the simulated Arduino core.
+ */
+
+#ifndef HOSTARDUINO_H
+#define HOSTARDUINO_H
+
+#include "Arduino.h"
+
+#define HOST_NUM_PINS 64
+
+/**
+ * @brief Receives level changes of the simulated pins.
+ *
+ * Simulated peripherals implement this interface and register themselves with
+ * hostAttachPinListener() to observe the edges generated by digitalWrite().
+ */
+
+class HostPinListener
+{
+public:
+    virtual ~HostPinListener() {}
+    virtual void pinChanged(const uint8_t pin, const uint8_t level) = 0;
+};
+
+void hostAttachPinListener(HostPinListener *listener);
+void hostDetachPinListener(HostPinListener *listener);
+
+/**
+ * @brief Drive a pin from outside the Arduino.
+ * @param pin
+ * @param level HIGH, LOW or -1 to release the pin
+ *
+ * digitalRead() returns the external level as long as the pin is not
+ * configured as an OUTPUT.
+ */
+
+void hostDrivePin(const uint8_t pin, const int level);
+
+/**
+ * @brief Level last written to a pin with digitalWrite().
+ */
+
+uint8_t hostPinLatch(const uint8_t pin);
+uint8_t hostPinMode(const uint8_t pin);
+
+/**
+ * @brief Number of pinMode() calls that changed the mode of a pin.
+ */
+
+unsigned long hostPinModeChanges();
+
+/**
+ * @brief Number of pinMode(), digitalWrite() and digitalRead() calls, whether
+ * or not they changed anything.
+ *
+ * Used to model the time the same code takes on a real Arduino.
+ */
+
+unsigned long hostPinModeCalls();
+unsigned long hostDigitalWrites();
+unsigned long hostDigitalReads();
+
+/**
+ * @brief digitalWrite() and digitalRead() for the simulated peripherals,
+ * not counted by hostDigitalWrites() and hostDigitalReads().
+ */
+
+void hostSetPin(const uint8_t pin, uint8_t val);
+int hostReadPin(const uint8_t pin);
+
+/**
+ * @brief Virtual time, in microseconds.
+ */
+
+unsigned long long hostMicros();
+void hostAdvanceMicros(const unsigned long long us);
+void hostResetClock();
+
+/**
+ * @brief Redirect Serial output to a string (NULL restores stdout).
+ */
+
+void hostCaptureSerial(std::string *sink);
+void hostFeedSerial(const char *data);
+
+#endif // HOSTARDUINO_H
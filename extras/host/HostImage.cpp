@@ -0,0 +1,66 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include <stdio.h>
+
+#include "HostImage.h"
+
+/**
+ * @brief Pseudo-random flash image, the same at every run.
+ * @param size
+ */
+
+std::vector<uint8_t> hostMakeImage(const size_t size)
+{
+    std::vector<uint8_t> image(size);
+    uint32_t x = 0x12345678;
+    for(size_t i = 0; i < size; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        image[i] = x & 0xff;
+    }
+    return image;
+}
+
+/**
+ * @brief Intel HEX lines for an image, 16 bytes per record, EOF included.
+ * @param image its size must be a multiple of 16
+ */
+
+std::vector<std::string> hostMakeHexLines(const std::vector<uint8_t> &image)
+{
+    std::vector<std::string> lines;
+    char buf[64];
+    for(size_t addr = 0; addr < image.size(); addr += 16) {
+        uint8_t sum = 0x10 + (addr >> 8) + (addr & 0xff);
+        int n = snprintf(buf, sizeof(buf), ":10%04X00", (unsigned)addr);
+        for(size_t i = 0; i < 16; i++) {
+            n += snprintf(buf + n, sizeof(buf) - n, "%02X", image[addr + i]);
+            sum += image[addr + i];
+        }
+        snprintf(buf + n, sizeof(buf) - n, "%02X", (uint8_t)(-sum));
+        lines.push_back(buf);
+    }
+    lines.push_back(":00000001FF");
+    return lines;
+}
@@ -0,0 +1,448 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "MAX1464Simulator.h"
+
+using namespace MAX1464_enums;
+
+MAX1464Simulator::MAX1464Simulator()
+{
+    memset(_partition0, 0xff, sizeof(_partition0));
+    memset(_partition1Flash, 0xff, sizeof(_partition1Flash));
+    memset(_ports, 0, sizeof(_ports));
+    memset(_modules, 0, sizeof(_modules));
+    _dhr = _pfar = _pc = _acc = 0;
+    _imr = IMR_4WIRE;
+    _halted = false;
+    _partition1 = false;
+    _attached = false;
+    _csPin = _clockPin = _dataInPin = _dataOutPin = 0;
+    _selected = false;
+    _outputOnDio = false;
+    _inShift = 0;
+    _outShift = 0;
+    _frameBits = 0;
+    _flashBusyUntil = 0;
+    memset(_adcCount, 0, sizeof(_adcCount));
+    memset(_adcPending, 0, sizeof(_adcPending));
+    _adcReadyAt = 0;
+    resetStats();
+}
+
+MAX1464Simulator::~MAX1464Simulator()
+{
+    detach();
+}
+
+/**
+ * @brief Connect the model to the simulated pins.
+ * @param chipSelect CS
+ * @param clock SCLK
+ * @param datain DI (DIO in 3-wire mode)
+ * @param dataout DO (same as datain for 3-wire wiring)
+ */
+
+void MAX1464Simulator::attach(const uint8_t chipSelect, const uint8_t clock,
+                              const uint8_t datain, const uint8_t dataout)
+{
+    detach();
+    _csPin = chipSelect;
+    _clockPin = clock;
+    _dataInPin = datain;
+    _dataOutPin = dataout;
+    _attached = true;
+    hostAttachPinListener(this);
+}
+
+void MAX1464Simulator::detach()
+{
+    if(!_attached)
+        return;
+    hostDetachPinListener(this);
+    hostDrivePin(_dataOutPin, -1);
+    hostDrivePin(_dataInPin, -1);
+    _attached = false;
+}
+
+void MAX1464Simulator::pinChanged(const uint8_t pin, const uint8_t level)
+{
+    if(pin == _csPin) {
+        if(level == LOW) {
+            beginFrame();
+            driveOutput();
+        }
+        else if(_selected) {
+            endFrame();
+            hostDrivePin(_dataOutPin, -1);
+            hostDrivePin(_dataInPin, -1);
+        }
+        return;
+    }
+    if(pin != _clockPin || !_selected)
+        return;
+    if(level == HIGH) {
+        _inShift = (_inShift >> 1) | (hostPinLatch(_dataInPin) << 7);
+        _frameBits++;
+        _stats.clocks++;
+    }
+    else {
+        _outShift <<= 1;
+        driveOutput();
+    }
+}
+
+void MAX1464Simulator::driveOutput()
+{
+    uint8_t bit = (_outShift >> 15) & 1;
+    if(_outputOnDio)
+        hostDrivePin(_dataInPin, bit);
+    else if(_dataOutPin != _dataInPin)
+        hostDrivePin(_dataOutPin, bit);
+}
+
+
+
+// frame level access
+
+void MAX1464Simulator::beginFrame()
+{
+    _selected = true;
+    _frameBits = 0;
+    _inShift = 0;
+    _outShift = _dhr;
+    _outputOnDio = _imr == IMR_3WIRE;
+}
+
+/**
+ * @brief Apply one SCLK period.
+ * @param di level of DI on the rising edge
+ * @return the level of DO sampled on the rising edge
+ */
+
+uint8_t MAX1464Simulator::clock(const uint8_t di)
+{
+    uint8_t out = (_outShift >> 15) & 1;
+    _inShift = (_inShift >> 1) | ((di & 1) << 7);
+    _frameBits++;
+    _stats.clocks++;
+    _outShift <<= 1;
+    return out;
+}
+
+void MAX1464Simulator::endFrame()
+{
+    _selected = false;
+    _stats.frames++;
+    if(_frameBits >= 16)
+        _stats.wordsOut++;
+    if(_outputOnDio) {
+        _imr = IMR_4WIRE;
+        return;
+    }
+    if(_frameBits == 8)
+        _stats.bytesIn++;
+    if(_frameBits >= 8)
+        processByte(_inShift);
+    else
+        _stats.protocolErrors++;
+}
+
+void MAX1464Simulator::writeByte(const uint8_t b)
+{
+    beginFrame();
+    for(uint8_t i = 0; i < 8; i++)
+        clock(b >> i);
+    endFrame();
+}
+
+uint16_t MAX1464Simulator::readWord()
+{
+    uint16_t w = 0;
+    beginFrame();
+    for(uint8_t i = 0; i < 16; i++)
+        w = (w << 1) | clock(0);
+    endFrame();
+    return w;
+}
+
+
+
+// interface registers
+
+void MAX1464Simulator::processByte(const uint8_t b)
+{
+    uint8_t nibble = b >> 4;
+    uint8_t irsa = b & 0xf;
+    if(irsa <= IRSA_DHR3) {
+        uint8_t shift = 4 * (irsa - IRSA_DHR0);
+        _dhr = (_dhr & ~(0xf << shift)) | (nibble << shift);
+    }
+    else if(irsa <= IRSA_PFAR3) {
+        uint8_t shift = 4 * (irsa - IRSA_PFAR0);
+        _pfar = (_pfar & ~(0xf << shift)) | (nibble << shift);
+    }
+    else if(irsa == IRSA_CR) {
+        _stats.commands[nibble]++;
+        executeCommand(nibble);
+    }
+    else if(irsa == IRSA_IMR)
+        _imr = nibble;
+    else
+        _stats.protocolErrors++;
+}
+
+uint8_t &MAX1464Simulator::flashCell(const uint16_t addr)
+{
+    if(_partition1)
+        return _partition1Flash[addr % MAX1464_SIM_PARTITION_1_SIZE];
+    return _partition0[addr % MAX1464_SIM_PARTITION_0_SIZE];
+}
+
+void MAX1464Simulator::checkFlashReady()
+{
+    if(hostMicros() < _flashBusyUntil)
+        _stats.timingViolations++;
+}
+
+void MAX1464Simulator::executeCommand(const uint8_t cmd)
+{
+    switch(cmd) {
+    case CR_WRITE16_DHR_TO_CPU_PORT: {
+        uint8_t port = _pfar & 0xf;
+        _ports[port] = _dhr;
+        if(port == MODULE_CONTROL_PORT && (_dhr & 0x8000)) {
+            uint8_t addr = _ports[MODULE_ADDRESS_PORT] & 0xff;
+            if(_dhr & 0x4000)
+                _ports[MODULE_DATA_PORT] = readModule(addr);
+            else
+                writeModule(addr, _ports[MODULE_DATA_PORT]);
+            _ports[MODULE_CONTROL_PORT] &= ~0x8000;
+        }
+        break;
+    }
+    case CR_WRITE8_DHR_TO_FLASH_MEMORY:
+        checkFlashReady();
+        flashCell(_pfar) &= _dhr & 0xff;
+        _flashBusyUntil = hostMicros() + MAX1464_SIM_FLASH_WRITE_TIME_US;
+        break;
+    case CR_READ16_CPU_PORT:
+        _dhr = _ports[_pfar & 0xf];
+        break;
+    case CR_READ8_FLASH:
+        checkFlashReady();
+        _dhr = flashCell(_pfar);
+        break;
+    case CR_READ16_CPU_ACC:
+        _dhr = _acc;
+        break;
+    case CR_READ8_FLASH_PC:
+        checkFlashReady();
+        _dhr = _partition0[_pc % MAX1464_SIM_PARTITION_0_SIZE];
+        break;
+    case CR_READ16_CPU_PC:
+        _dhr = _pc;
+        break;
+    case CR_HALT_CPU:
+        _halted = true;
+        _partition1 = false;
+        break;
+    case CR_START_CPU:
+        _halted = false;
+        break;
+    case CR_SINGLE_STEP_CPU:
+        stepCpu();
+        break;
+    case CR_RESET_PC:
+        _pc = 0;
+        break;
+    case CR_RESET_MODULES:
+        memset(_modules, 0, sizeof(_modules));
+        break;
+    case CR_NOP:
+        break;
+    case CR_ERASE_FLASH_PAGE: {
+        checkFlashReady();
+        uint16_t page = _pfar & ~(MAX1464_SIM_PAGE_SIZE - 1);
+        for(uint16_t i = 0; i < MAX1464_SIM_PAGE_SIZE; i++)
+            flashCell(page + i) = 0xff;
+        _flashBusyUntil = hostMicros() + MAX1464_SIM_FLASH_ERASE_TIME_US;
+        break;
+    }
+    case CR_ERASE_FLASH_PARTITION:
+        checkFlashReady();
+        if(_partition1)
+            memset(_partition1Flash, 0xff, sizeof(_partition1Flash));
+        else
+            memset(_partition0, 0xff, sizeof(_partition0));
+        _flashBusyUntil = hostMicros() + MAX1464_SIM_FLASH_ERASE_TIME_US;
+        break;
+    case CR_SELECT_FLASH_PARTITION_1:
+        _partition1 = true;
+        break;
+    }
+}
+
+static const uint16_t adcBits[3] = {CNVT_ADC_1, CNVT_ADC_2, CNVT_ADC_T};
+static const uint8_t adcDataRegisters[3] = {
+    R_ADC_DATA_1, R_ADC_DATA_2, R_ADC_DATA_T};
+
+void MAX1464Simulator::writeModule(const uint8_t addr, const uint16_t data)
+{
+    updateAdc();
+    _modules[addr] = data;
+    if(addr != R_ADC_CONTROL)
+        return;
+    for(uint8_t c = 0; c < 3; c++) {
+        if(data & adcBits[c]) {
+            _adcPending[c] = adcInput(c, data);
+            _stats.adcConversions++;
+        }
+    }
+    _adcReadyAt = hostMicros() + MAX1464_SIM_ADC_CONVERSION_TIME_US;
+}
+
+uint16_t MAX1464Simulator::readModule(const uint8_t addr)
+{
+    updateAdc();
+    for(uint8_t c = 0; c < 3; c++) {
+        if(addr == adcDataRegisters[c]
+                && (_modules[R_ADC_CONTROL] & adcBits[c]))
+            _stats.earlyAdcReads++;
+    }
+    return _modules[addr];
+}
+
+/**
+ * @brief Result of a conversion.
+ * @param channel 0 for ADC_1, 1 for ADC_2, 2 for ADC_T
+ * @param control the value written to ADC_CONTROL
+ *
+ * The default is a per-channel conversion counter times 16, plus the channel.
+ */
+
+uint16_t MAX1464Simulator::adcInput(const uint8_t channel,
+                                    const uint16_t control)
+{
+    (void)control;
+    return (_adcCount[channel]++ << 4) | channel;
+}
+
+/**
+ * @brief Complete the conversion in progress, if its time has come.
+ */
+
+void MAX1464Simulator::updateAdc()
+{
+    uint16_t &control = _modules[R_ADC_CONTROL];
+    if(!(control & (CNVT_ADC_1 | CNVT_ADC_2 | CNVT_ADC_T))
+            || hostMicros() < _adcReadyAt)
+        return;
+    for(uint8_t c = 0; c < 3; c++) {
+        if(control & adcBits[c])
+            _modules[adcDataRegisters[c]] = _adcPending[c];
+    }
+    control &= ~(CNVT_ADC_1 | CNVT_ADC_2 | CNVT_ADC_T);
+}
+
+/**
+ * @brief Execute one CPU instruction.
+ *
+ * The CPU is not modeled: the program counter is just advanced.
+ */
+
+void MAX1464Simulator::stepCpu()
+{
+    _pc = (_pc + 1) % MAX1464_SIM_PARTITION_0_SIZE;
+}
+
+
+
+// device state
+
+uint8_t MAX1464Simulator::flashByte(const FLASH_PARTITION partition,
+                                    const uint16_t addr) const
+{
+    if(partition == PARTITION_1)
+        return _partition1Flash[addr % MAX1464_SIM_PARTITION_1_SIZE];
+    return _partition0[addr % MAX1464_SIM_PARTITION_0_SIZE];
+}
+
+void MAX1464Simulator::setFlashByte(const FLASH_PARTITION partition,
+                                    const uint16_t addr, const uint8_t value)
+{
+    if(partition == PARTITION_1)
+        _partition1Flash[addr % MAX1464_SIM_PARTITION_1_SIZE] = value;
+    else
+        _partition0[addr % MAX1464_SIM_PARTITION_0_SIZE] = value;
+}
+
+uint16_t MAX1464Simulator::cpuPort(const CPU_PORT port) const
+{
+    return _ports[port & 0xf];
+}
+
+void MAX1464Simulator::setCpuPort(const CPU_PORT port, const uint16_t value)
+{
+    _ports[port & 0xf] = value;
+}
+
+uint16_t MAX1464Simulator::moduleRegister(const uint8_t addr) const
+{
+    return _modules[addr];
+}
+
+void MAX1464Simulator::setModuleRegister(
+        const uint8_t addr, const uint16_t value)
+{
+    _modules[addr] = value;
+}
+
+void MAX1464Simulator::resetStats()
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+
+
+// SimulatedMAX1464
+
+SimulatedMAX1464::SimulatedMAX1464(
+        MAX1464Simulator &device, const int chipSelect) :
+    AbstractMAX1464(chipSelect), device(device)
+{
+}
+
+void SimulatedMAX1464::begin()
+{
+    writeNibble(IMR_4WIRE, IRSA_IMR);
+}
+
+void SimulatedMAX1464::byteShiftOut(const uint8_t b, const char *debugMsg) const
+{
+    (void)debugMsg;
+    device.writeByte(b);
+}
+
+uint16_t SimulatedMAX1464::wordShiftIn() const
+{
+    return device.readWord();
+}
@@ -0,0 +1,168 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464SIMULATOR_H
+#define MAX1464SIMULATOR_H
+
+#include "HostArduino.h"
+#include "AbstractMAX1464.h"
+
+#define MAX1464_SIM_PARTITION_0_SIZE 0x1000
+#define MAX1464_SIM_PARTITION_1_SIZE 0x80
+#define MAX1464_SIM_PAGE_SIZE 0x80
+#define MAX1464_SIM_FLASH_WRITE_TIME_US 100
+#define MAX1464_SIM_FLASH_ERASE_TIME_US 5000
+#define MAX1464_SIM_ADC_CONVERSION_TIME_US 500
+
+/**
+ * @brief In-process model of the %MAX1464 serial interface.
+ *
+ * The model implements the interface registers (DHR, PFAR, CR, IMR), both
+ * flash partitions, the 16 CPU ports and the module register file reached
+ * through ports D, E and F. It can be driven either frame by frame (see
+ * SimulatedMAX1464) or at pin level, by attaching it to the simulated pins
+ * so that the unmodified MAX1464 and MAX1464_SS classes talk to it.
+ *
+ * Serial protocol model:
+ * - every frame is full duplex: while CS is low, the DHR content loaded at
+ *   the CS falling edge is shifted out MSB first on DO, and DI is sampled on
+ *   SCK rising edges, LSB first;
+ * - the last 8 bits received are latched on the CS rising edge;
+ * - writing IMR_3WIRE makes the next frame an output-only frame on DIO, after
+ *   which the interface returns to 4-wire operation;
+ * - CR_SELECT_FLASH_PARTITION_1 selects partition 1 until the CPU is halted;
+ * - flash commands issued while a write or erase is still in progress are
+ *   counted as timing violations.
+ *
+ * ADC model: writing the CNVT_ADC_* bits to ADC_CONTROL starts a conversion
+ * of the selected channels, whose results (see adcInput()) appear in the
+ * ADC_DATA_* registers after MAX1464_SIM_ADC_CONVERSION_TIME_US, when the
+ * CNVT bits are cleared. Reading a data register of a conversion still in
+ * progress returns the previous result and is counted in earlyAdcReads.
+ */
+
+class MAX1464Simulator : public HostPinListener
+{
+public:
+    struct Stats {
+        unsigned long frames;
+        unsigned long bytesIn;
+        unsigned long wordsOut;
+        unsigned long clocks;
+        unsigned long timingViolations;
+        unsigned long protocolErrors;
+        unsigned long adcConversions;
+        unsigned long earlyAdcReads;
+        unsigned long commands[16];
+    };
+
+    MAX1464Simulator();
+    virtual ~MAX1464Simulator();
+
+    void attach(const uint8_t chipSelect, const uint8_t clock,
+                const uint8_t datain, const uint8_t dataout);
+    void detach();
+    virtual void pinChanged(const uint8_t pin, const uint8_t level);
+
+    // frame level access
+    void beginFrame();
+    uint8_t clock(const uint8_t di);
+    void endFrame();
+    void writeByte(const uint8_t b);
+    uint16_t readWord();
+
+    // device state
+    uint8_t flashByte(const MAX1464_enums::FLASH_PARTITION partition,
+                      const uint16_t addr) const;
+    void setFlashByte(const MAX1464_enums::FLASH_PARTITION partition,
+                      const uint16_t addr, const uint8_t value);
+    uint16_t cpuPort(const MAX1464_enums::CPU_PORT port) const;
+    void setCpuPort(const MAX1464_enums::CPU_PORT port, const uint16_t value);
+    uint16_t moduleRegister(const uint8_t addr) const;
+    void setModuleRegister(const uint8_t addr, const uint16_t value);
+    uint16_t dhr() const { return _dhr; }
+    uint16_t pfar() const { return _pfar; }
+    uint8_t imr() const { return _imr; }
+    boolean isCpuHalted() const { return _halted; }
+    boolean isPartition1Selected() const { return _partition1; }
+    uint16_t programCounter() const { return _pc; }
+    uint16_t accumulator() const { return _acc; }
+
+    const Stats &stats() const { return _stats; }
+    void resetStats();
+
+protected:
+    virtual void executeCommand(const uint8_t cmd);
+    virtual void writeModule(const uint8_t addr, const uint16_t data);
+    virtual uint16_t readModule(const uint8_t addr);
+    virtual void stepCpu();
+    virtual uint16_t adcInput(const uint8_t channel, const uint16_t control);
+
+    uint8_t _partition0[MAX1464_SIM_PARTITION_0_SIZE];
+    uint8_t _partition1Flash[MAX1464_SIM_PARTITION_1_SIZE];
+    uint16_t _ports[16];
+    uint16_t _modules[256];
+    uint16_t _dhr, _pfar, _pc, _acc;
+    uint8_t _imr;
+    boolean _halted, _partition1;
+    unsigned long _adcCount[3];  // conversions of ADC_1, ADC_2, ADC_T
+    Stats _stats;
+
+private:
+    void processByte(const uint8_t b);
+    uint8_t &flashCell(const uint16_t addr);
+    void checkFlashReady();
+    void driveOutput();
+    void updateAdc();
+
+    boolean _attached;
+    uint8_t _csPin, _clockPin, _dataInPin, _dataOutPin;
+    boolean _selected, _outputOnDio;
+    uint8_t _inShift;
+    uint16_t _outShift;
+    unsigned int _frameBits;
+    unsigned long long _flashBusyUntil;
+    uint16_t _adcPending[3];
+    unsigned long long _adcReadyAt;
+};
+
+
+/**
+ * @brief AbstractMAX1464 implementation connected directly to a
+ * MAX1464Simulator, without going through the simulated pins.
+ */
+
+class SimulatedMAX1464 : public AbstractMAX1464
+{
+public:
+    SimulatedMAX1464(MAX1464Simulator &device, const int chipSelect = 10);
+    virtual void begin();
+
+    virtual void byteShiftOut(
+            const uint8_t b, const char *debugMsg = NULL) const;
+    virtual uint16_t wordShiftIn() const;
+
+private:
+    MAX1464Simulator &device;
+};
+
+#endif // MAX1464SIMULATOR_H
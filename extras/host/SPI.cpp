@@ -0,0 +1,87 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "SPI.h"
+#include "HostArduino.h"
+
+SPIClass SPI;
+
+void SPIClass::begin()
+{
+    pinMode(SPI_PIN_SCK, OUTPUT);
+    pinMode(SPI_PIN_MOSI, OUTPUT);
+    pinMode(SPI_PIN_MISO, INPUT);
+    digitalWrite(SPI_PIN_SCK, LOW);
+    digitalWrite(SPI_PIN_MOSI, LOW);
+}
+
+void SPIClass::end()
+{
+}
+
+void SPIClass::beginTransaction(const SPISettings &settings)
+{
+    current = settings;
+    transactions++;
+}
+
+void SPIClass::endTransaction()
+{
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+    uint8_t in = 0;
+    for(uint8_t i = 0; i < 8; i++) {
+        uint8_t bit = current.bitOrder == LSBFIRST ? i : 7 - i;
+        hostSetPin(SPI_PIN_MOSI, !!(data & (1 << bit)));
+        hostSetPin(SPI_PIN_SCK, HIGH);
+        in |= hostReadPin(SPI_PIN_MISO) << bit;
+        hostSetPin(SPI_PIN_SCK, LOW);
+    }
+    bytes++;
+    return in;
+}
+
+// same byte ordering as the AVR core
+uint16_t SPIClass::transfer16(uint16_t data)
+{
+    uint8_t lsb = data & 0xff, msb = data >> 8;
+    if(current.bitOrder == LSBFIRST) {
+        lsb = transfer(lsb);
+        msb = transfer(msb);
+    }
+    else {
+        msb = transfer(msb);
+        lsb = transfer(lsb);
+    }
+    return (msb << 8) | lsb;
+}
+
+void SPIClass::transfer(void *buf, size_t count)
+{
+    uint8_t *p = (uint8_t *)buf;
+    while(count--) {
+        *p = transfer(*p);
+        p++;
+    }
+}
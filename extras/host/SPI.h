@@ -0,0 +1,82 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Host-side replacement for the Arduino SPI library.
+ *
+ * Transfers are clocked bit by bit on the simulated MOSI, MISO and SCK pins
+ * (the Arduino Uno ones), so that simulated peripherals see the same edges
+ * as with software SPI. Only SPI_MODE0 is implemented.
+ */
+
+#ifndef SPI_H
+#define SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+#define SPI_PIN_SS   10
+#define SPI_PIN_MOSI 11
+#define SPI_PIN_MISO 12
+#define SPI_PIN_SCK  13
+
+class SPISettings
+{
+public:
+    SPISettings(uint32_t clock = 4000000, uint8_t bitOrder = MSBFIRST,
+                uint8_t dataMode = SPI_MODE0) :
+        clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass
+{
+public:
+    void begin();
+    void end();
+    void beginTransaction(const SPISettings &settings);
+    void endTransaction();
+
+    uint8_t transfer(uint8_t data);
+    uint16_t transfer16(uint16_t data);
+    void transfer(void *buf, size_t count);
+
+    /**
+     * @brief Number of beginTransaction() calls since the last reset.
+     */
+    unsigned long transactions;
+    /**
+     * @brief Number of bytes transferred since the last reset.
+     */
+    unsigned long bytes;
+
+private:
+    SPISettings current;
+};
+
+extern SPIClass SPI;
+
+#endif // SPI_H
@@ -0,0 +1,265 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Benchmark the driver hot paths against the simulated device, with
+ * the hardware and the software SPI transports.
+ *
+ * The results are printed as a JSON array, one object per line. For each
+ * transport and operation they give the bus traffic per operation, the time
+ * the operation would take on an Arduino Uno according to a simple cost
+ * model, and the speed of the host build.
+ *
+ * With --no-timing the host speed is left out, and the output only depends
+ * on the library: `make run` compares it with bench.json, so that changes in
+ * the bus traffic show up in review. `make bench-baseline` updates the file.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "HostArduino.h"
+#include "HostImage.h"
+#include "MAX1464Simulator.h"
+#include "MAX1464.h"
+#include "MAX1464_SS.h"
+#include "MAX1464Helpers.h"
+
+using namespace MAX1464_enums;
+
+#define CS_PIN 10
+#define MOSI_PIN 11
+#define MISO_PIN 12
+#define SCK_PIN 13
+
+/**
+ * @brief Cost of the Arduino core calls on a 16 MHz ATmega328P, in us.
+ *
+ * Rough figures for the stock AVR core. The time spent in the library code
+ * itself is not modeled, so the estimates are a lower bound for the bus
+ * bound operations.
+ */
+
+#define MODEL_DIGITAL_WRITE_US 3.4
+#define MODEL_DIGITAL_READ_US 3.0
+#define MODEL_PIN_MODE_US 3.0
+#define MODEL_SPI_BYTE_US 2.4          // 8 clocks at 4 MHz, plus SPDR polling
+#define MODEL_SPI_TRANSACTION_US 0.8   // beginTransaction() + endTransaction()
+
+struct Counters {
+    unsigned long bytesIn;
+    unsigned long wordsOut;
+    unsigned long frames;
+    unsigned long digitalWrites;
+    unsigned long digitalReads;
+    unsigned long pinModes;
+    unsigned long spiBytes;
+    unsigned long spiTransactions;
+    unsigned long long virtualMicros;
+};
+
+static Counters sample(const MAX1464Simulator &device)
+{
+    Counters c;
+    c.bytesIn = device.stats().bytesIn;
+    c.wordsOut = device.stats().wordsOut;
+    c.frames = device.stats().frames;
+    c.digitalWrites = hostDigitalWrites();
+    c.digitalReads = hostDigitalReads();
+    c.pinModes = hostPinModeCalls();
+    c.spiBytes = SPI.bytes;
+    c.spiTransactions = SPI.transactions;
+    c.virtualMicros = hostMicros();
+    return c;
+}
+
+class Benchmark
+{
+public:
+    Benchmark(MAX1464Simulator &device) : device(device) {
+        begin = sample(device);
+        start = std::chrono::steady_clock::now();
+    }
+
+    void report(const char *transport, const char *operation,
+                const unsigned long ops, const bool ok) const;
+
+    static bool timing;
+    static bool first;
+
+private:
+    MAX1464Simulator &device;
+    Counters begin;
+    std::chrono::steady_clock::time_point start;
+};
+
+bool Benchmark::timing = true;
+bool Benchmark::first = true;
+
+void Benchmark::report(const char *transport, const char *operation,
+                       const unsigned long ops, const bool ok) const
+{
+    const double wallSeconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    const Counters end = sample(device);
+    const double busBytes = (end.bytesIn - begin.bytesIn)
+            + 2.0 * (end.wordsOut - begin.wordsOut);
+    const double delayMicros = end.virtualMicros - begin.virtualMicros;
+    const double modelMicros = delayMicros
+            + MODEL_DIGITAL_WRITE_US * (end.digitalWrites - begin.digitalWrites)
+            + MODEL_DIGITAL_READ_US * (end.digitalReads - begin.digitalReads)
+            + MODEL_PIN_MODE_US * (end.pinModes - begin.pinModes)
+            + MODEL_SPI_BYTE_US * (end.spiBytes - begin.spiBytes)
+            + MODEL_SPI_TRANSACTION_US
+            * (end.spiTransactions - begin.spiTransactions);
+
+    printf("%s{\"transport\": \"%s\", \"operation\": \"%s\", \"ops\": %lu, "
+           "\"bus_bytes_per_op\": %.2f, \"frames_per_op\": %.2f, "
+           "\"delay_us_per_op\": %.1f, \"model_us_per_op\": %.1f",
+           first ? "[\n" : ",\n", transport, operation, ops,
+           busBytes / ops, (double)(end.frames - begin.frames) / ops,
+           delayMicros / ops, modelMicros / ops);
+    if(timing)
+        printf(", \"ops_per_sec\": %.0f", ops / wallSeconds);
+    printf(", \"ok\": %s}", ok ? "true" : "false");
+    first = false;
+}
+
+static bool bench(const char *transport, AbstractMAX1464 &max1464,
+                  MAX1464Simulator &device)
+{
+    bool allOk = true;
+    const std::vector<uint8_t> image =
+            hostMakeImage(MAX1464_SIM_PARTITION_0_SIZE);
+    const std::vector<std::string> lines = hostMakeHexLines(image);
+
+    max1464.begin();
+
+    // flash a 4 KB image from HEX lines
+    const unsigned long images = 4;
+    bool ok = true;
+    Benchmark flash(device);
+    for(unsigned long n = 0; n < images; n++) {
+        max1464.beginWritingToFlashPartition(PARTITION_0);
+        for(size_t i = 0; i < lines.size(); i++)
+            ok &= max1464.writeHexLineToFlashMemory(String(lines[i]));
+    }
+    flash.report(transport, "flash-hex-4k", images, ok);
+    for(size_t i = 0; i < image.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == image[i];
+    allOk &= ok;
+
+    // dump both partitions in Intel HEX format
+    const unsigned long dumps = 4;
+    std::string text;
+    hostCaptureSerial(&text);
+    Benchmark dump(device);
+    for(unsigned long n = 0; n < dumps; n++) {
+        text.clear();
+        max1464.readFlashPartition(PARTITION_0);
+        max1464.readFlashPartition(PARTITION_1);
+    }
+    hostCaptureSerial(NULL);
+    std::string expected;
+    for(size_t i = 0; i < lines.size(); i++)
+        expected += lines[i] + "\r\n";
+    ok = text.compare(0, expected.length(), expected) == 0;
+    dump.report(transport, "dump-partitions", dumps, ok);
+    allOk &= ok;
+
+    // poll a module register
+    const unsigned long reads = 2000;
+    device.setModuleRegister(R_ADC_DATA_1, 0x5a3c);
+    ok = true;
+    Benchmark module(device);
+    for(unsigned long n = 0; n < reads; n++)
+        ok &= max1464.readModuleRegister(R_ADC_DATA_1) == 0x5a3c;
+    module.report(transport, "poll-module-reg", reads, ok);
+    allOk &= ok;
+
+    // read a CPU port
+    device.setCpuPort(CPU_PORT_A, 0x1234);
+    ok = true;
+    Benchmark port(device);
+    for(unsigned long n = 0; n < reads; n++)
+        ok &= max1464.readCpuPort(CPU_PORT_A) == 0x1234;
+    port.report(transport, "read-cpu-port", reads, ok);
+    allOk &= ok;
+
+    // cycle through the ADC channels
+    static const AdcScanStep steps[] = {
+        {CNVT_ADC_1, CONFIGA_PGA_GAIN_31 | CONFIGA_RES_16BIT,
+         CONFIGB_REF_2VREF},
+        {CNVT_ADC_2, CONFIGA_PGA_GAIN_31 | CONFIGA_RES_16BIT,
+         CONFIGB_REF_4VBG},
+        {CNVT_ADC_T, CONFIGA_RES_12BIT, CONFIGB_REF_VDD},
+        {CNVT_ADC_1 | CNVT_SE_VDD, CONFIGA_RES_12BIT, CONFIGB_REF_2VREF},
+    };
+    const unsigned long cycles = 200;
+    uint16_t results[4];
+    max1464.haltCpu();
+    AdcScanList scan(max1464);
+    ok = scan.begin(steps, 4, MAX1464_SIM_ADC_CONVERSION_TIME_US);
+    const unsigned long earlyReads = device.stats().earlyAdcReads;
+    Benchmark adc(device);
+    for(unsigned long n = 0; n < cycles; n++)
+        scan.scan(results);
+    ok &= device.stats().earlyAdcReads == earlyReads;
+    adc.report(transport, "adc-scan-cycle", cycles, ok);
+    allOk &= ok;
+
+    allOk &= device.stats().timingViolations == 0;
+    allOk &= device.stats().protocolErrors == 0;
+    max1464.end();
+    return allOk;
+}
+
+int main(int argc, char **argv)
+{
+    bool ok = true;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--no-timing") == 0) {
+            Benchmark::timing = false;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--no-timing]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    {
+        MAX1464Simulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464 max1464(CS_PIN);
+        ok &= bench("spi", max1464, device);
+    }
+    {
+        MAX1464Simulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464_SS max1464(CS_PIN);
+        max1464.setSpiPins(MOSI_PIN, MISO_PIN, SCK_PIN);
+        ok &= bench("ss", max1464, device);
+    }
+    printf("\n]\n");
+
+    return ok ? 0 : 1;
+}
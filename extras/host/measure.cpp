@@ -0,0 +1,950 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Measure bus traffic and time of the main library operations against
+ * the simulated device, for every transport.
+ *
+ * The exit status is non-zero if any operation did not produce the expected
+ * device state or output.
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "HostArduino.h"
+#include "HostImage.h"
+#include "MAX1464Simulator.h"
+#include "MAX1464.h"
+#include "MAX1464_SS.h"
+#include "MAX1464_FastSS.h"
+#include "MAX1464_ParallelSS.h"
+#include "MAX1464Helpers.h"
+
+using namespace MAX1464_enums;
+
+#define CS_PIN 10
+#define MOSI_PIN 11
+#define MISO_PIN 12
+#define SCK_PIN 13
+
+struct Measurement {
+    MAX1464Simulator::Stats stats;
+    unsigned long spiTransactions;
+    unsigned long pinModeChanges;
+    unsigned long digitalWrites;
+    unsigned long long virtualMicros;
+    double wallNanos;
+};
+
+class Probe
+{
+public:
+    Probe(MAX1464Simulator &device) : device(device) {
+        device.resetStats();
+        startTransactions = SPI.transactions;
+        startPinModeChanges = hostPinModeChanges();
+        startDigitalWrites = hostDigitalWrites();
+        startMicros = hostMicros();
+        start = std::chrono::steady_clock::now();
+    }
+    Measurement stop() const {
+        Measurement m;
+        m.wallNanos = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count();
+        m.stats = device.stats();
+        m.spiTransactions = SPI.transactions - startTransactions;
+        m.pinModeChanges = hostPinModeChanges() - startPinModeChanges;
+        m.digitalWrites = hostDigitalWrites() - startDigitalWrites;
+        m.virtualMicros = hostMicros() - startMicros;
+        return m;
+    }
+
+private:
+    MAX1464Simulator &device;
+    unsigned long startTransactions;
+    unsigned long startPinModeChanges;
+    unsigned long startDigitalWrites;
+    unsigned long long startMicros;
+    std::chrono::steady_clock::time_point start;
+};
+
+// the flash waits are padded by the micros() step of a 16 MHz AVR
+static_assert(MAX1464_MICROS_RESOLUTION == 4, "");
+
+// register builders fold to the same constants as the enums
+using namespace MAX1464_registers;
+static_assert(CONFIGA_PGA_01 == CONFIGA_PGA_GAIN_7_7, "");
+static_assert(CONFIGA_CLK6 == 0x0600, "");
+static_assert(AdcConfigA().pga(CONFIGA_PGA_GAIN_31).clock(CONFIGA_CLK6)
+              .resolution(CONFIGA_RES_16BIT).coarseOffset(CONFIGA_CO3)
+              == 0x2663, "");
+static_assert(AdcConfigA(0xffff).clock(CONFIGA_CLK_1MHz) == 0xf8ff, "");
+static_assert(AdcConfigB().bias(CONFIGB_BIAS_8_8).reference(CONFIGB_REF_4VBG)
+              == 0x0072, "");
+static_assert(DopControl().pwm(true).dac(true).pwm(false) == 0x0001, "");
+static_assert(TmrConfig().prescaler<32>().count<625>() == TMR_CONFIG_10ms, "");
+static_assert(TmrConfig().prescaler<384>().count<2604>() == TMR_CONFIG_500ms,
+              "");
+static_assert(OscControl().trim<-3>() == OSC_TRIM_m3, "");
+static_assert(OscControl().trim<-16>().clockOutput(true)
+              == (OSC_TRIM_m16 | OSC_ENCKOUT), "");
+static_assert(OscControl().trim<15>() == OscControl().trim(OSC_TRIM_15), "");
+
+/**
+ * @brief Simulated device whose firmware publishes the Adler-32 of partition 0
+ * on CHECKSUM_PORT (low word) and the next port (high word) when the CPU is
+ * started.
+ */
+
+#define CHECKSUM_PORT CPU_PORT_E
+
+class ChecksummingSimulator : public MAX1464Simulator
+{
+protected:
+    virtual void executeCommand(const uint8_t cmd) {
+        MAX1464Simulator::executeCommand(cmd);
+        if(cmd != CR_START_CPU)
+            return;
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for(uint16_t i = 0; i < MAX1464_SIM_PARTITION_0_SIZE; i++) {
+            a = (a + _partition0[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        _ports[CHECKSUM_PORT] = a;
+        _ports[CHECKSUM_PORT + 1] = b;
+    }
+};
+
+static void report(const char *transport, const char *operation,
+                   const unsigned long count, const Measurement &m,
+                   const bool ok)
+{
+    printf("%-10s %-16s %6lu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %11.2f "
+           "%11.1f %s\n",
+           transport, operation, count,
+           (double)m.stats.frames / count,
+           (double)m.spiTransactions / count,
+           (double)m.pinModeChanges / count,
+           (double)m.digitalWrites / count,
+           (double)m.stats.bytesIn / count,
+           (double)m.stats.wordsOut / count,
+           (double)m.virtualMicros / count,
+           m.wallNanos / count,
+           ok && m.stats.timingViolations == 0 ? "ok" : "FAIL");
+}
+
+static bool measure(const char *transport, AbstractMAX1464 &max1464,
+                    MAX1464Simulator &device)
+{
+    bool allOk = true;
+    const std::vector<uint8_t> image =
+            hostMakeImage(MAX1464_SIM_PARTITION_0_SIZE);
+    const std::vector<std::string> lines = hostMakeHexLines(image);
+
+    max1464.begin();
+
+    // flash partition 0
+    Probe flashProbe(device);
+    max1464.beginWritingToFlashPartition(PARTITION_0);
+    bool ok = true;
+    for(size_t i = 0; i < lines.size(); i++)
+        ok &= max1464.writeHexLineToFlashMemory(String(lines[i]));
+    Measurement m = flashProbe.stop();
+    ok &= max1464.hasEOFBeenReached();
+    ok &= !max1464.writeHexLineToFlashMemory(String(":0100000000FE"));
+    ok &= max1464.hexLineStatus() == IntelHexParser::HEX_ERR_CHECKSUM;
+    for(size_t i = 0; i < image.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == image[i];
+    report(transport, "flash/byte", image.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // flash partition 0 with the non-blocking engine, spending 20 us on
+    // other work between polls
+    FlashProgrammer programmer(max1464);
+    IntelHexParser parser;
+    Probe programmerProbe(device);
+    ok = programmer.begin(PARTITION_0);
+    unsigned long polls = 0, idlePolls = 0;
+    for(size_t i = 0; i < lines.size(); i++) {
+        ok &= parser.feed(lines[i].c_str(), lines[i].length())
+                == IntelHexParser::HEX_RECORD_READY;
+        while(!programmer.feed(parser)) {
+            idlePolls += !programmer.poll();
+            polls++;
+            hostAdvanceMicros(20);
+        }
+    }
+    while(!programmer.isIdle()) {
+        idlePolls += !programmer.poll();
+        polls++;
+        hostAdvanceMicros(20);
+    }
+    m = programmerProbe.stop();
+    ok &= programmer.hasEOFBeenReached();
+    ok &= programmer.bytesWritten() == image.size();
+    for(size_t i = 0; i < image.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == image[i];
+    report(transport, "flash-nb/byte", image.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+    printf("%-10s %-16s %6lu polls, %.1f%% of them found the device busy\n",
+           transport, "flash-nb", polls, 100.0 * idlePolls / polls);
+
+    // verify partition 0 with the checksum computed on chip
+    FlashVerifier verifier(max1464);
+    verifier.setChecksumPort(CHECKSUM_PORT, 1);
+    verifier.begin(PARTITION_0);
+    for(size_t i = 0; i < lines.size(); i++) {
+        parser.feed(lines[i].c_str(), lines[i].length());
+        verifier.writeHexRecord(parser);
+    }
+    Probe verifyProbe(device);
+    ok = verifier.verify() && !verifier.hasReadBack();
+    m = verifyProbe.stop();
+    report(transport, "verify/image", 1, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // a corrupted byte falls back to readback and is located
+    device.setFlashByte(PARTITION_0, 0x234, image[0x234] ^ 0x40);
+    Probe mismatchProbe(device);
+    ok = !verifier.verify() && verifier.hasReadBack();
+    m = mismatchProbe.stop();
+    ok &= verifier.pagesMismatched() == 1;
+    ok &= verifier.isPageMismatched(0x234 / MAX1464_FLASH_PAGE_SIZE);
+    device.setFlashByte(PARTITION_0, 0x234, image[0x234]);
+    report(transport, "verify-bad/image", 1, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // two swapped bytes keep the byte sum but not the checksum
+    size_t swap = 0x345;
+    while(image[swap] == image[swap + 1])
+        swap++;
+    device.setFlashByte(PARTITION_0, swap, image[swap + 1]);
+    device.setFlashByte(PARTITION_0, swap + 1, image[swap]);
+    Probe swapProbe(device);
+    ok = !verifier.verify() && verifier.hasReadBack();
+    m = swapProbe.stop();
+    ok &= verifier.pagesMismatched() == 1;
+    ok &= verifier.isPageMismatched(swap / MAX1464_FLASH_PAGE_SIZE);
+    device.setFlashByte(PARTITION_0, swap, image[swap]);
+    device.setFlashByte(PARTITION_0, swap + 1, image[swap + 1]);
+    report(transport, "verify-swap/img", 1, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // dump partition 0
+    std::string dump;
+    hostCaptureSerial(&dump);
+    Probe dumpProbe(device);
+    max1464.readFlashPartition(PARTITION_0);
+    m = dumpProbe.stop();
+    hostCaptureSerial(NULL);
+    std::string expected;
+    for(size_t i = 0; i < lines.size(); i++)
+        expected += lines[i] + "\r\n";
+    ok = dump == expected;
+    report(transport, "dump/byte", image.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // bulk read of partition 0
+    std::vector<uint8_t> readback(image.size());
+    Probe readProbe(device);
+    max1464.readFlash(PARTITION_0, 0, readback.size(), readback.data());
+    m = readProbe.stop();
+    ok = readback == image;
+    report(transport, "read/byte", image.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // differential update: one page only needs bits cleared, one needs an
+    // erase; with fingerprints, the other pages are not even read back
+    std::vector<uint8_t> updated = image;
+    updated[0x105] &= 0x0f;
+    updated[0x9a0] = ~updated[0x9a0];
+    const std::vector<std::string> updatedLines = hostMakeHexLines(updated);
+    uint16_t fingerprints[MAX1464_FLASH_PAGES];
+    for(size_t p = 0; p < MAX1464_FLASH_PAGES; p++)
+        fingerprints[p] = IncrementalFlashWriter::pageFingerprint(
+                    &image[p * MAX1464_FLASH_PAGE_SIZE]);
+    IncrementalFlashWriter writer(max1464);
+    Probe updateProbe(device);
+    writer.begin(PARTITION_0, fingerprints);
+    ok = true;
+    for(size_t i = 0; i < updatedLines.size(); i++) {
+        parser.feed(updatedLines[i].c_str(), updatedLines[i].length());
+        ok &= writer.writeHexRecord(parser);
+    }
+    m = updateProbe.stop();
+    ok &= writer.hasEOFBeenReached();
+    ok &= writer.pagesErased() == 1 && writer.pagesPatched() == 1;
+    ok &= writer.pagesSkipped() == MAX1464_FLASH_PAGES - 2;
+    for(size_t i = 0; i < updated.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == updated[i];
+    report(transport, "update/image", 1, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // restore the original image, comparing every page with the device
+    writer.begin(PARTITION_0);
+    for(size_t i = 0; i < lines.size(); i++) {
+        parser.feed(lines[i].c_str(), lines[i].length());
+        writer.writeHexRecord(parser);
+    }
+    ok = writer.pagesErased() == 2 && writer.pagesPatched() == 0;
+    for(size_t i = 0; i < image.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == image[i];
+    allOk &= ok;
+
+    // flash a half-blank image, skipping the 0xFF bytes
+    std::vector<uint8_t> padded = image;
+    for(size_t i = padded.size() / 2; i < padded.size(); i++)
+        padded[i] = 0xff;
+    const std::vector<std::string> paddedLines = hostMakeHexLines(padded);
+    max1464.setSkipErasedBytes(true);
+    const unsigned long skippedBefore = max1464.skippedFlashWrites();
+    Probe skipProbe(device);
+    max1464.beginWritingToFlashPartition(PARTITION_0);
+    ok = true;
+    for(size_t i = 0; i < paddedLines.size(); i++)
+        ok &= max1464.writeHexLineToFlashMemory(String(paddedLines[i]));
+    m = skipProbe.stop();
+    max1464.setSkipErasedBytes(false);
+    ok &= max1464.skippedFlashWrites() - skippedBefore >= padded.size() / 2;
+    for(size_t i = 0; i < padded.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == padded[i];
+    report(transport, "flash-skip/byte", padded.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // module register reads
+    const unsigned long reads = 1000;
+    device.setModuleRegister(R_ADC_CONFIG_1A, 0x5a3c);
+    Probe moduleProbe(device);
+    ok = true;
+    for(unsigned long i = 0; i < reads; i++)
+        ok &= max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x5a3c;
+    m = moduleProbe.stop();
+    report(transport, "readModuleReg", reads, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // the same, skipping the module address port writes
+    max1464.setModulePortCache(true);
+    max1464.haltCpu();
+    Probe cachedProbe(device);
+    ok = true;
+    for(unsigned long i = 0; i < reads; i++)
+        ok &= max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x5a3c;
+    m = cachedProbe.stop();
+    report(transport, "readModReg-cache", reads, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // the firmware moves the address port while the CPU runs
+    max1464.releaseCpu();
+    device.setCpuPort(MODULE_ADDRESS_PORT, R_ADC_CONFIG_2A);
+    max1464.haltCpu();
+    ok = max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x5a3c;
+    max1464.writeModuleRegister(0x0123, R_ADC_CONFIG_2A);
+    device.setCpuPort(MODULE_DATA_PORT, 0);
+    max1464.invalidateRegisterCache();
+    max1464.writeModuleRegister(0x0123, R_ADC_CONFIG_2A);
+    ok &= device.moduleRegister(R_ADC_CONFIG_2A) == 0x0123;
+
+    // the same, with the CPU started or stepped through writeCR()
+    max1464.writeCR(CR_START_CPU);
+    device.setCpuPort(MODULE_ADDRESS_PORT, R_ADC_CONFIG_2A);
+    max1464.writeCR(CR_HALT_CPU);
+    ok &= max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x5a3c;
+    max1464.writeCR(CR_SINGLE_STEP_CPU);
+    device.setCpuPort(MODULE_ADDRESS_PORT, R_ADC_CONFIG_2A);
+    ok &= max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x5a3c;
+    max1464.setModulePortCache(false);
+    allOk &= ok;
+
+    // save a profile, switch to another one differing in 3 registers, and
+    // back
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++)
+        device.setModuleRegister(ModuleRegisterBank::address(i), 0x100 + i);
+    ModuleRegisterBank bank(max1464);
+    MAX1464RegisterSnapshot profileA, profileB;
+    Probe snapshotProbe(device);
+    bank.readAll(profileA);
+    m = snapshotProbe.stop();
+    ok = true;
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++)
+        ok &= profileA.values[i] == 0x100 + i;
+    report(transport, "snapshot/reg", MAX1464_CONFIG_REGISTERS, m, ok);
+    allOk &= ok;
+
+    profileB = profileA;
+    profileB.values[ModuleRegisterBank::indexOf(R_ADC_CONFIG_1A)] = 0x0461;
+    profileB.values[ModuleRegisterBank::indexOf(R_DOP2_DATA)] = 0x8000;
+    profileB.values[ModuleRegisterBank::indexOf(R_GPIO1_CONTROL)] = 0x0003;
+    Probe restoreProbe(device);
+    ok = bank.restore(profileB) == 3;
+    m = restoreProbe.stop();
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++)
+        ok &= device.moduleRegister(ModuleRegisterBank::address(i))
+                == profileB.values[i];
+    report(transport, "restore-diff", 1, m, ok);
+    allOk &= ok;
+
+    ok = bank.restore(profileA) == 3 && bank.restore(profileA) == 0;
+    bank.invalidate();
+    uint16_t config = 0x1234;
+    ok &= !bank.value(R_ADC_CONFIG_1A, config) && config == 0x1234;
+    Probe fullProbe(device);
+    ok &= bank.restore(profileB) == MAX1464_CONFIG_REGISTERS;
+    m = fullProbe.stop();
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++)
+        ok &= device.moduleRegister(ModuleRegisterBank::address(i))
+                == profileB.values[i];
+    report(transport, "restore-full", 1, m, ok);
+    allOk &= ok;
+
+    // change a field without reading the device
+    Probe fieldProbe(device);
+    ok = !bank.value(R_ADC_CONTROL, config);
+    ok &= bank.value(R_ADC_CONFIG_1A, config);
+    ok &= bank.write(MAX1464_registers::AdcConfigA(config)
+                     .resolution(CONFIGA_RES_12BIT), R_ADC_CONFIG_1A);
+    m = fieldProbe.stop();
+    ok &= device.moduleRegister(R_ADC_CONFIG_1A) == 0x0421;
+    ok &= m.stats.wordsOut == 0;
+    ok &= !bank.write(0x0421, R_ADC_CONFIG_1A);
+    report(transport, "write-field", 1, m, ok);
+    allOk &= ok;
+
+    // paced ADC acquisition, drained by the consumer
+    const unsigned long period = 1000;
+    const unsigned long ticks = 200;
+    AdcAcquisition adc(max1464);
+    AdcSample sample;
+    max1464.haltCpu();
+    Probe adcProbe(device);
+    adc.begin(CNVT_ADC_1 | CNVT_ADC_T, period);
+    // polls are not aligned with the ticks: samples carry the time the
+    // conversion was actually started, which lags the schedule
+    std::vector<unsigned long> started(1, micros());
+    const unsigned long t0 = started[0];
+    const unsigned long pollPeriod = 70;
+    ok = true;
+    for(unsigned long n = 0; n < ticks; ) {
+        hostAdvanceMicros(pollPeriod);
+        const unsigned long now = micros();
+        if(adc.poll())
+            started.push_back(now);
+        while(adc.read(sample)) {
+            ok &= sample.timestamp == started[n];
+            ok &= sample.timestamp - (t0 + n * period) < pollPeriod;
+            ok &= sample.adc1 == (n << 4);
+            ok &= sample.adcT == ((n << 4) | 2);
+            ok &= sample.adc2 == 0;
+            n++;
+        }
+    }
+    m = adcProbe.stop();
+    ok &= adc.overruns() == 0 && adc.missedTicks() == 0;
+    ok &= m.stats.earlyAdcReads == 0;
+    report(transport, "adc-sample", ticks, m, ok);
+    allOk &= ok;
+
+    // without a consumer the buffer fills up; late polls skip ticks
+    for(unsigned long i = 0; i < 2 * MAX1464_ADC_BUFFER_SIZE; i++) {
+        hostAdvanceMicros(period);
+        adc.poll();
+    }
+    ok = adc.available() == MAX1464_ADC_BUFFER_SIZE - 1;
+    ok &= adc.overruns() == MAX1464_ADC_BUFFER_SIZE + 1;
+    hostAdvanceMicros(3 * period + period / 2);
+    adc.poll();
+    ok &= adc.missedTicks() == 2;
+    adc.end();
+    allOk &= ok;
+
+    max1464.end();
+    return allOk;
+}
+
+/**
+ * @brief Subset of measure() for drivers with the bus inlined, which cannot
+ * be used with the helpers taking an AbstractMAX1464.
+ */
+
+template <class Driver>
+static bool measureInline(const char *transport, Driver &max1464,
+                          MAX1464Simulator &device)
+{
+    bool allOk = true;
+    const std::vector<uint8_t> image =
+            hostMakeImage(MAX1464_SIM_PARTITION_0_SIZE);
+    const std::vector<std::string> lines = hostMakeHexLines(image);
+
+    max1464.begin();
+
+    Probe flashProbe(device);
+    max1464.beginWritingToFlashPartition(PARTITION_0);
+    bool ok = true;
+    for(size_t i = 0; i < lines.size(); i++)
+        ok &= max1464.writeHexLineToFlashMemory(String(lines[i]));
+    Measurement m = flashProbe.stop();
+    for(size_t i = 0; i < image.size(); i++)
+        ok &= device.flashByte(PARTITION_0, i) == image[i];
+    report(transport, "flash/byte", image.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    std::vector<uint8_t> readback(image.size());
+    Probe readProbe(device);
+    max1464.readFlash(PARTITION_0, 0, readback.size(), readback.data());
+    m = readProbe.stop();
+    ok = readback == image;
+    report(transport, "read/byte", image.size(), m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    const unsigned long reads = 1000;
+    device.setModuleRegister(R_ADC_CONFIG_1A, 0x5a3c);
+    Probe moduleProbe(device);
+    ok = true;
+    for(unsigned long i = 0; i < reads; i++)
+        ok &= max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x5a3c;
+    m = moduleProbe.stop();
+    report(transport, "readModuleReg", reads, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    max1464.end();
+    return allOk;
+}
+
+/**
+ * @brief Program and read back a fixture of devices sharing the bus.
+ */
+
+static bool measureGroup(const char *transport, AbstractMAX1464 &bus,
+                         const uint8_t miso)
+{
+    static const uint8_t chipSelects[] = {CS_PIN, 9, 8, 7};
+    const size_t n = sizeof(chipSelects);
+    bool allOk = true;
+    const std::vector<uint8_t> image =
+            hostMakeImage(MAX1464_SIM_PARTITION_0_SIZE);
+    const std::vector<std::string> lines = hostMakeHexLines(image);
+
+    std::vector<MAX1464Simulator *> devices;
+    MAX1464Group group(bus, chipSelects[0]);
+    for(size_t i = 0; i < n; i++) {
+        devices.push_back(new ChecksummingSimulator);
+        devices[i]->attach(chipSelects[i], SCK_PIN, MOSI_PIN, miso);
+        if(i > 0)
+            group.addDevice(chipSelects[i]);
+    }
+
+    // the bus fills its own address shadows before the group takes over
+    uint8_t byte;
+    bus.begin();
+    bus.readFlash(PARTITION_0, 0x10, 1, &byte);
+    group.begin();
+
+    // flash every device at once
+    Probe flashProbe(*devices[0]);
+    group.beginWritingToFlashPartition(PARTITION_0);
+    bool ok = true;
+    for(size_t i = 0; i < lines.size(); i++)
+        ok &= group.writeHexLineToFlashMemory(String(lines[i]));
+    Measurement m = flashProbe.stop();
+    for(size_t d = 0; d < n; d++) {
+        for(size_t i = 0; i < image.size(); i++)
+            ok &= devices[d]->flashByte(PARTITION_0, i) == image[i];
+        ok &= devices[d]->stats().timingViolations == 0;
+    }
+    report(transport, "gang-flash/byte", image.size() * n, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    // read each device back in turn, after corrupting one of them
+    devices[2]->setFlashByte(PARTITION_0, 0x123, 0x00);
+    std::vector<uint8_t> readback(image.size());
+    Probe readProbe(*devices[0]);
+    ok = true;
+    for(size_t d = 0; d < n; d++) {
+        group.setReadDevice(d);
+        group.readFlash(PARTITION_0, 0, readback.size(), readback.data());
+        ok &= (readback == image) == (d != 2);
+    }
+    m = readProbe.stop();
+    report(transport, "gang-read/byte", image.size() * n, m, ok);
+    allOk &= ok;
+
+    // empty selections are rejected; the bus gets its chip select back and
+    // addresses the device again instead of trusting stale shadows
+    Probe handoverProbe(*devices[0]);
+    ok = !group.selectDevices(0) && !group.selectDevices(1 << n);
+    ok &= group.selectedDevices() == (1 << n) - 1;
+    ok &= group.selectDevices(0x06 | 1 << n);
+    ok &= group.selectedDevices() == 0x06;
+    group.end();
+    ok &= bus.chipSelect() == CS_PIN;
+    bus.readFlash(PARTITION_0, 0x10, 1, &byte);
+    ok &= byte == image[0x10];
+    m = handoverProbe.stop();
+    report(transport, "gang-handover", 1, m, ok);
+    allOk &= ok;
+
+    for(size_t d = 0; d < n; d++)
+        delete devices[d];
+    return allOk;
+}
+
+/**
+ * @brief Read back and verify a fixture of devices in parallel.
+ */
+
+static bool measureParallel(const char *transport)
+{
+    static const uint8_t chipSelects[] = {CS_PIN, 9, 8, 7};
+    static const uint8_t dataIns[] = {MISO_PIN, 2, 3, 4};
+    const size_t n = sizeof(chipSelects);
+    bool allOk = true;
+    const std::vector<uint8_t> image =
+            hostMakeImage(MAX1464_SIM_PARTITION_0_SIZE);
+    const std::vector<std::string> lines = hostMakeHexLines(image);
+
+    std::vector<MAX1464Simulator *> devices;
+    MAX1464_ParallelSS fixture(MOSI_PIN, SCK_PIN, chipSelects[0], dataIns[0]);
+    for(size_t i = 0; i < n; i++) {
+        devices.push_back(new ChecksummingSimulator);
+        devices[i]->attach(chipSelects[i], SCK_PIN, MOSI_PIN, dataIns[i]);
+        if(i > 0)
+            fixture.addDevice(chipSelects[i], dataIns[i]);
+    }
+    fixture.begin();
+
+    Probe flashProbe(*devices[0]);
+    fixture.beginWritingToFlashPartition(PARTITION_0);
+    bool ok = true;
+    for(size_t i = 0; i < lines.size(); i++)
+        ok &= fixture.writeHexLineToFlashMemory(String(lines[i]));
+    Measurement m = flashProbe.stop();
+    for(size_t d = 0; d < n; d++) {
+        for(size_t i = 0; i < image.size(); i++)
+            ok &= devices[d]->flashByte(PARTITION_0, i) == image[i];
+        ok &= devices[d]->stats().timingViolations == 0;
+    }
+    report(transport, "gang-flash/byte", image.size() * n, m, ok);
+    allOk &= ok && m.stats.timingViolations == 0;
+
+    std::vector<std::vector<uint8_t> > readback(
+                n, std::vector<uint8_t>(image.size()));
+    uint8_t *out[MAX1464_GROUP_SIZE];
+    for(size_t d = 0; d < n; d++)
+        out[d] = readback[d].data();
+    Probe readProbe(*devices[0]);
+    fixture.readFlashAll(PARTITION_0, 0, image.size(), out);
+    m = readProbe.stop();
+    ok = true;
+    for(size_t d = 0; d < n; d++)
+        ok &= readback[d] == image;
+    report(transport, "gang-read/byte", image.size() * n, m, ok);
+    allOk &= ok;
+
+    devices[1]->setFlashByte(PARTITION_0, 0x777, 0x00);
+    devices[3]->setFlashByte(PARTITION_0, 0x001, 0x00);
+    Probe verifyProbe(*devices[0]);
+    ok = fixture.verifyFlash(PARTITION_0, 0, image.data(), image.size())
+            == ((1 << 1) | (1 << 3));
+    m = verifyProbe.stop();
+    report(transport, "gang-verify/byte", image.size() * n, m, ok);
+    allOk &= ok;
+
+    devices[2]->setModuleRegister(R_ADC_CONFIG_1A, 0x1234);
+    fixture.readModuleRegister(R_ADC_CONFIG_1A);
+    allOk &= fixture.lastWord(2) == 0x1234;
+
+    for(size_t d = 0; d < n; d++)
+        delete devices[d];
+    return allOk;
+}
+
+/**
+ * @brief Flash a fixture of devices with independent images, interleaving
+ * the bus traffic while the others are programming.
+ */
+
+static bool measureScheduler(const char *transport)
+{
+    static const uint8_t chipSelects[] = {CS_PIN, 9, 8, 7};
+    const size_t n = sizeof(chipSelects);
+    bool ok = true;
+
+    std::vector<MAX1464Simulator *> devices;
+    MAX1464 drivers[] = {MAX1464(chipSelects[0]), MAX1464(chipSelects[1]),
+                         MAX1464(chipSelects[2]), MAX1464(chipSelects[3])};
+    std::vector<FlashProgrammer *> programmers;
+    std::vector<std::vector<uint8_t> > images;
+    MAX1464RegisterWrite writes[] = {{0x1234, R_ADC_CONFIG_1A},
+                                     {0x0042, R_DOP1_CONFIG}};
+    FlashScheduler scheduler;
+    for(size_t i = 0; i < n; i++) {
+        devices.push_back(new ChecksummingSimulator);
+        devices[i]->attach(chipSelects[i], SCK_PIN, MOSI_PIN, MISO_PIN);
+        drivers[i].begin();
+        programmers.push_back(new FlashProgrammer(drivers[i]));
+        images.push_back(hostMakeImage(MAX1464_SIM_PARTITION_0_SIZE - 256 * i));
+        ok &= scheduler.addDevice(*programmers[i]) == (int8_t)i;
+        scheduler.setImage(i, PARTITION_0, 0, images[i].data(),
+                           images[i].size());
+        scheduler.setRegisterWrites(i, writes, 2);
+    }
+
+    size_t total = 0;
+    for(size_t i = 0; i < n; i++)
+        total += images[i].size();
+
+    Probe probe(*devices[0]);
+    ok &= scheduler.begin();
+    while(scheduler.poll())
+        hostAdvanceMicros(1);
+    Measurement m = probe.stop();
+    ok &= scheduler.isDone() && scheduler.totalBytesWritten() == total;
+    for(size_t d = 0; d < n; d++) {
+        for(size_t i = 0; i < images[d].size(); i++)
+            ok &= devices[d]->flashByte(PARTITION_0, i) == images[d][i];
+        ok &= devices[d]->moduleRegister(R_ADC_CONFIG_1A) == 0x1234;
+        ok &= devices[d]->moduleRegister(R_DOP1_CONFIG) == 0x0042;
+        ok &= devices[d]->stats().timingViolations == 0;
+        ok &= scheduler.progress(d) == 100;
+    }
+    ok &= scheduler.bytesPerSecond()
+            == total * 1000000ULL / scheduler.elapsedMicros();
+    report(transport, "sched-flash/byte", total, m, ok);
+
+    for(size_t d = 0; d < n; d++) {
+        delete programmers[d];
+        delete devices[d];
+    }
+    return ok;
+}
+
+/**
+ * @brief Simulated device whose conversion results depend on the ADC
+ * configuration in use, to check that each conversion gets its own.
+ */
+
+class AdcEchoSimulator : public MAX1464Simulator
+{
+protected:
+    virtual uint16_t adcInput(const uint8_t channel, const uint16_t control) {
+        return _modules[R_ADC_CONFIG_1A + 3 * channel]
+                + _modules[R_ADC_CONFIG_1B + 3 * channel] + (control >> 8);
+    }
+};
+
+/**
+ * @brief Cycle through ADC channels with different configurations, with an
+ * AdcScanList and by writing all the registers at each step.
+ */
+
+static bool measureScan(const char *transport, AbstractMAX1464 &max1464,
+                        AdcEchoSimulator &device)
+{
+    static const AdcScanStep steps[] = {
+        {CNVT_ADC_1, CONFIGA_PGA_GAIN_31 | CONFIGA_RES_16BIT,
+         CONFIGB_REF_2VREF},
+        {CNVT_ADC_2, CONFIGA_PGA_GAIN_31 | CONFIGA_RES_16BIT,
+         CONFIGB_REF_4VBG},
+        {CNVT_ADC_T, CONFIGA_RES_12BIT, CONFIGB_REF_VDD},
+        {CNVT_ADC_1 | CNVT_SE_VDD, CONFIGA_RES_12BIT, CONFIGB_REF_2VREF},
+    };
+    const uint8_t n = sizeof(steps) / sizeof(steps[0]);
+    const unsigned long conversion = MAX1464_SIM_ADC_CONVERSION_TIME_US;
+    const unsigned long cycles = 100;
+    bool allOk = true;
+    uint16_t results[n];
+
+    max1464.begin();
+    max1464.haltCpu();
+
+    // each step must start exactly one conversion
+    static const AdcScanStep twoAdcs[] = {
+        {CNVT_ADC_1 | CNVT_ADC_T, CONFIGA_RES_12BIT, CONFIGB_REF_VDD},
+    };
+    static const AdcScanStep noAdc[] = {
+        {CNVT_SE_VDD, CONFIGA_RES_12BIT, CONFIGB_REF_VDD},
+    };
+    AdcScanList scan(max1464);
+    bool ok = !scan.begin(twoAdcs, 1, conversion);
+    ok &= !scan.begin(noAdc, 1, conversion);
+    ok &= scan.stepCount() == 0;
+    ok &= scan.begin(steps, n, conversion);
+    ok &= scan.configWritesPerCycle() == 2;
+    Probe scanProbe(device);
+    for(unsigned long c = 0; c < cycles; c++) {
+        scan.scan(results);
+        for(uint8_t i = 0; i < n; i++)
+            ok &= results[i] == steps[i].configA + steps[i].configB
+                    + (steps[i].control >> 8);
+    }
+    Measurement m = scanProbe.stop();
+    ok &= m.stats.earlyAdcReads == 0;
+    // a rejected list replaces the good one instead of leaving it active
+    ok &= !scan.begin(noAdc, 1, conversion);
+    ok &= scan.stepCount() == 0;
+    report(transport, "adc-scan/cycle", cycles, m, ok);
+    allOk &= ok;
+
+    // baseline: configure every step from scratch
+    Probe naiveProbe(device);
+    ok = true;
+    for(unsigned long c = 0; c < cycles; c++) {
+        for(uint8_t i = 0; i < n; i++) {
+            const uint8_t adc = steps[i].control & CNVT_ADC_1 ? 0
+                    : steps[i].control & CNVT_ADC_2 ? 1 : 2;
+            max1464.writeModuleRegister(steps[i].configA,
+                    (MODULE_REGISTER_ADDRESS)(R_ADC_CONFIG_1A + 3 * adc));
+            max1464.writeModuleRegister(steps[i].configB,
+                    (MODULE_REGISTER_ADDRESS)(R_ADC_CONFIG_1B + 3 * adc));
+            max1464.writeModuleRegister(steps[i].control, R_ADC_CONTROL);
+            delayMicroseconds(conversion);
+            ok &= max1464.readModuleRegister(
+                        (MODULE_REGISTER_ADDRESS)(R_ADC_DATA_1 + 3 * adc))
+                    == steps[i].configA + steps[i].configB
+                    + (steps[i].control >> 8);
+        }
+    }
+    m = naiveProbe.stop();
+    report(transport, "adc-naive/cycle", cycles, m, ok);
+    allOk &= ok;
+
+    max1464.end();
+    return allOk;
+}
+
+/**
+ * @brief Records longer than printHexRecord() accepts.
+ */
+
+static bool checkLongHexRecords()
+{
+    std::vector<uint8_t> data(200, 0x5a);
+    std::vector<char> buf(HEX_RECORD_BUFFER_SIZE(200));
+    bool ok = formatHexRecord(buf.data(), 0, 0, data.data(), 200)
+            == HEX_RECORD_BUFFER_SIZE(200) - 1;
+    std::string text;
+    hostCaptureSerial(&text);
+    ok &= !printHexRecord(Serial, 0, 0, data.data(),
+                          HEX_RECORD_PRINT_MAX_DATA + 1);
+    ok &= printHexRecord(Serial, 0, 0, data.data(), HEX_RECORD_PRINT_MAX_DATA);
+    hostCaptureSerial(NULL);
+    ok &= text.length() == HEX_RECORD_BUFFER_SIZE(16) - 1;
+
+    // the parser takes records up to MAX1464_HEX_MAX_DATA bytes
+    IntelHexParser parser;
+    size_t n = formatHexRecord(buf.data(), 0, 0, data.data(),
+                               MAX1464_HEX_MAX_DATA);
+    ok &= parser.feed(buf.data(), n) == IntelHexParser::HEX_RECORD_READY;
+    ok &= parser.byteCount() == MAX1464_HEX_MAX_DATA;
+    n = formatHexRecord(buf.data(), 0, 0, data.data(),
+                        MAX1464_HEX_MAX_DATA + 1);
+    ok &= parser.feed(buf.data(), n) == IntelHexParser::HEX_ERR_LENGTH;
+    printf("%-10s %-16s %s\n", "-", "hex-long-record", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    printf("%-10s %-16s %6s %9s %9s %9s %9s %9s %9s %11s %11s %s\n",
+           "transport", "operation", "count", "frames", "spi_txn",
+           "pin_modes", "dig_wr", "bytes", "words", "virt_us", "wall_ns",
+           "check");
+
+    ok &= checkLongHexRecords();
+
+    {
+        ChecksummingSimulator device;
+        SimulatedMAX1464 max1464(device, CS_PIN);
+        ok &= measure("direct", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464 max1464(CS_PIN);
+        ok &= measure("spi", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464_SS max1464(CS_PIN);
+        max1464.setSpiPins(MOSI_PIN, MISO_PIN, SCK_PIN);
+        ok &= measure("ss-4wire", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MOSI_PIN);
+        MAX1464_SS max1464(CS_PIN);
+        max1464.setSpiPins(MOSI_PIN, MOSI_PIN, SCK_PIN);
+        ok &= measure("ss-3wire", max1464, device);
+    }
+    {
+        MAX1464 bus(CS_PIN);
+        ok &= measureGroup("spi-group", bus, MISO_PIN);
+    }
+    {
+        MAX1464_SS bus(CS_PIN);
+        bus.setSpiPins(MOSI_PIN, MOSI_PIN, SCK_PIN);
+        ok &= measureGroup("ss3-group", bus, MOSI_PIN);
+    }
+    ok &= measureParallel("parallel");
+    ok &= measureScheduler("spi-sched");
+    {
+        AdcEchoSimulator device;
+        SimulatedMAX1464 max1464(device, CS_PIN);
+        ok &= measureScan("direct", max1464, device);
+    }
+    {
+        AdcEchoSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464 max1464(CS_PIN);
+        ok &= measureScan("spi", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464_Inline max1464(CS_PIN);
+        ok &= measureInline("spi-inl", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464_SS_Inline max1464(CS_PIN);
+        max1464.setSpiPins(MOSI_PIN, MISO_PIN, SCK_PIN);
+        ok &= measureInline("ss-inl", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+        MAX1464_FastSS<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN> max1464;
+        ok &= measureInline("fast-4wire", max1464, device);
+    }
+    {
+        ChecksummingSimulator device;
+        device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MOSI_PIN);
+        MAX1464_FastSS<MOSI_PIN, MOSI_PIN, SCK_PIN, CS_PIN,
+                MAX1464DelayMicros<1> > max1464;
+        ok &= measureInline("fast-3wire", max1464, device);
+    }
+
+    return ok ? 0 : 1;
+}
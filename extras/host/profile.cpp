@@ -0,0 +1,150 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Check the CpuProfiler against a simulated device whose CPU stops at
+ * known addresses.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "HostArduino.h"
+#include "MAX1464Simulator.h"
+#include "MAX1464.h"
+#include "MAX1464Helpers.h"
+
+using namespace MAX1464_enums;
+
+#define CS_PIN 10
+#define HALT_US 12  // time the CPU stays halted for each sample
+
+/**
+ * @brief Simulated device whose CPU, when halted, is found at the next
+ * address of a pseudo-random sequence, and stays halted for HALT_US.
+ *
+ * The addresses cover [0, 0x3ff], so that some of them fall outside the
+ * histogram of the check.
+ */
+
+class ScriptedPcSimulator : public MAX1464Simulator
+{
+public:
+    ScriptedPcSimulator() : _random(0x2545f491) {}
+
+    std::vector<uint16_t> stops;
+
+protected:
+    virtual void executeCommand(const uint8_t cmd) {
+        MAX1464Simulator::executeCommand(cmd);
+        if(cmd != CR_HALT_CPU)
+            return;
+        _random ^= _random << 13;
+        _random ^= _random >> 17;
+        _random ^= _random << 5;
+        _pc = _random & 0x3ff;
+        stops.push_back(_pc);
+        hostAdvanceMicros(HALT_US);
+    }
+
+private:
+    uint32_t _random;
+};
+
+static void check(const char *operation, const bool ok)
+{
+    printf("%-10s %-16s %s\n", "profile", operation, ok ? "ok" : "FAIL");
+}
+
+int main()
+{
+    bool ok = true;
+    ScriptedPcSimulator device;
+    device.attach(CS_PIN, SPI_PIN_SCK, SPI_PIN_MOSI, SPI_PIN_MISO);
+    MAX1464 max1464(CS_PIN);
+    max1464.begin();
+
+    // 256 addresses in 64 bins; polls are not aligned with the period
+    const uint16_t first = 0x100;
+    const uint16_t last = 0x1ff;
+    const unsigned long period = 1000;
+    const unsigned long samples = 2000;
+    CpuProfiler profiler(max1464);
+    profiler.begin(period, 250, first, last);
+    device.resetStats();
+    device.stops.clear();
+    while(profiler.samples() < samples) {
+        hostAdvanceMicros(30);
+        profiler.poll();
+    }
+    const unsigned long elapsed = profiler.elapsedMicros();
+
+    // every sample lands in the bin of the address the CPU was stopped at
+    bool pass = profiler.binWidth() == 4;
+    pass &= device.stops.size() == samples;
+    unsigned long expected[MAX1464_PROFILER_BINS] = {0};
+    unsigned long outside = 0;
+    for(size_t i = 0; i < device.stops.size(); i++) {
+        const uint16_t pc = device.stops[i];
+        if(pc < first || pc > last)
+            outside++;
+        else
+            expected[(pc - first) / 4]++;
+    }
+    unsigned long total = profiler.outOfRange();
+    for(uint8_t b = 0; b < MAX1464_PROFILER_BINS; b++) {
+        pass &= profiler.binCount(b) == expected[b];
+        total += profiler.binCount(b);
+    }
+    pass &= total == profiler.samples();
+    pass &= profiler.outOfRange() == outside && outside > 0;
+    pass &= profiler.lastProgramCounter() == device.stops.back();
+    check("histogram", pass);
+    ok &= pass;
+
+    // each sample is one batched halt/read/release
+    pass = device.stats().frames == 4 * samples;
+    pass &= elapsed + 2 * period > samples * period
+            && elapsed < samples * period + 2 * period;
+    check("schedule", pass);
+    ok &= pass;
+
+    // the halted time is accounted for, and printed as parts per million
+    pass = profiler.overheadMicros() == HALT_US * samples;
+    pass &= profiler.maxOverheadMicros() == HALT_US;
+    const unsigned long ppm = 1e6 * profiler.overheadMicros() / elapsed;
+    pass &= ppm > 0.99e6 * HALT_US / period && ppm < 1.01e6 * HALT_US / period;
+    std::string text;
+    hostCaptureSerial(&text);
+    profiler.print(Serial);
+    hostCaptureSerial(NULL);
+    char line[64];
+    snprintf(line, sizeof(line), "samples %lu\r\nout of range %lu\r\n",
+             samples, outside);
+    pass &= text.find(line) != std::string::npos;
+    snprintf(line, sizeof(line), "overhead ppm %lu\r\n", ppm);
+    pass &= text.find(line) != std::string::npos;
+    if(!pass)
+        printf("%s", text.c_str());
+    check("overhead", pass);
+    ok &= pass;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Check the bus trace, built with MAX1464_TRACE, against the simulated
+ * device.
+ * \brief Check the performance counters, built with MAX1464_STATS, against the
+ * simulated device.
+ */
+
+#include <stdio.h>
+#include <string>
+
+#include "HostArduino.h"
+#include "MAX1464Simulator.h"
+#include "MAX1464.h"
+
+using namespace MAX1464_enums;
+
+#define CS_PIN 10
+#define MOSI_PIN 11
+#define MISO_PIN 12
+#define SCK_PIN 13
+
+static void check(const char *operation, const bool ok)
+{
+    printf("%-10s %-16s %s\n", "stats", operation, ok ? "ok" : "FAIL");
+}
+
+static unsigned long histogramCount(const MAX1464Stats &stats,
+                                    const MAX1464Stats::Operation op)
+{
+    unsigned long n = 0;
+    for(uint8_t b = 0; b < MAX1464_STATS_BUCKETS; b++)
+        n += stats.histograms[op][b];
+    return n;
+}
+
+int main()
+{
+    bool ok = true;
+    MAX1464Simulator device;
+    device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+    device.setModuleRegister(R_ADC_CONFIG_1A, 0x1234);
+    MAX1464 max1464(CS_PIN);
+    max1464.begin();
+
+    // bus counters agree with the frames seen by the device
+    max1464.clearStats();
+    device.resetStats();
+    max1464.haltCpu();
+    for(int i = 0; i < 4; i++)
+        max1464.readModuleRegister(R_ADC_CONFIG_1A);
+    max1464.readCpuPort(CPU_PORT_A);
+    const MAX1464Stats &stats = max1464.stats();
+    bool pass = stats.bytesOut == device.stats().bytesIn;
+    pass &= stats.wordsIn == device.stats().wordsOut && stats.wordsIn == 5;
+    pass &= stats.transactions > stats.wordsIn;
+    pass &= stats.transactions < stats.bytesOut;  // writes are batched
+    pass &= stats.delayMicros == 0;
+    check("counters", pass);
+    ok &= pass;
+
+    // one histogram entry per operation
+    pass = histogramCount(stats, MAX1464Stats::READ_MODULE_REGISTER) == 4;
+    pass &= histogramCount(stats, MAX1464Stats::READ_CPU_PORT) == 5;
+    pass &= histogramCount(stats, MAX1464Stats::WRITE_BYTE_TO_FLASH) == 0;
+    check("histogram", pass);
+    ok &= pass;
+
+    // waits are counted, and land in the bucket of their duration
+    max1464.clearStats();
+    max1464.eraseFlashPartition(PARTITION_0);
+    for(uint16_t addr = 0; addr < 8; addr++)
+        max1464.writeByteToFlash(0x5a, addr);
+    pass = stats.delayMicros ==
+            MAX1464_FLASH_ERASE_TIME_MS * 1000UL
+            + 8 * MAX1464_FLASH_WRITE_TIME_US;
+    const uint8_t erase = MAX1464Stats::bucket(
+                MAX1464_FLASH_ERASE_TIME_MS * 1000UL);
+    const uint8_t write = MAX1464Stats::bucket(MAX1464_FLASH_WRITE_TIME_US);
+    pass &= stats.histograms[MAX1464Stats::ERASE_FLASH_PARTITION][erase] == 1;
+    pass &= stats.histograms[MAX1464Stats::WRITE_BYTE_TO_FLASH][write] == 8;
+    check("delay", pass);
+    ok &= pass;
+
+    // bucket edges
+    pass = MAX1464Stats::bucket(0) == 0 && MAX1464Stats::bucket(1) == 1;
+    pass &= MAX1464Stats::bucket(3) == 2 && MAX1464Stats::bucket(4) == 3;
+    pass &= MAX1464Stats::bucket(0xffffffffUL) == MAX1464_STATS_BUCKETS - 1;
+    check("bucket", pass);
+    ok &= pass;
+
+    // printed report
+    std::string text;
+    hostCaptureSerial(&text);
+    stats.print(Serial);
+    hostCaptureSerial(NULL);
+    pass = text.find("delay us 5800\r\n") != std::string::npos;
+    pass &= text.find("writeByteToFlash 127:8\r\n") != std::string::npos;
+    pass &= text.find("readCpuPort") == std::string::npos;
+    if(!pass)
+        printf("%s", text.c_str());
+    check("print", pass);
+    ok &= pass;
+
+    return ok ? 0 : 1;
+}
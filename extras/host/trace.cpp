@@ -0,0 +1,113 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ * \brief Check the bus trace, built with MAX1464_TRACE, against the simulated
+ * device.
+ */
+
+#include <stdio.h>
+#include <string>
+
+#include "HostArduino.h"
+#include "MAX1464Simulator.h"
+#include "MAX1464.h"
+
+using namespace MAX1464_enums;
+
+#define CS_PIN 10
+#define MOSI_PIN 11
+#define MISO_PIN 12
+#define SCK_PIN 13
+
+static void check(const char *operation, const bool ok)
+{
+    printf("%-10s %-16s %s\n", "trace", operation, ok ? "ok" : "FAIL");
+}
+
+int main()
+{
+    bool ok = true;
+    MAX1464Simulator device;
+    device.attach(CS_PIN, SCK_PIN, MOSI_PIN, MISO_PIN);
+    device.setModuleRegister(R_ADC_CONFIG_1A, 0x1234);
+    MAX1464 max1464(CS_PIN);
+    max1464.begin();
+
+    // one module register read, decoded
+    hostAdvanceMicros(1000);
+    MAX1464Trace::clear();
+    max1464.haltCpu();
+    bool pass = max1464.readModuleRegister(R_ADC_CONFIG_1A) == 0x1234;
+    std::string text;
+    hostCaptureSerial(&text);
+    MAX1464Trace::print(Serial);
+    hostCaptureSerial(NULL);
+    for(size_t i; (i = text.find('\r')) != std::string::npos; )
+        text.erase(i, 1);
+    const std::string expected =
+            "1000 W IRSA_CR CR_HALT_CPU\n"
+            "1000 W IRSA_DHR3 0x0\n"
+            "1000 W IRSA_DHR2 0x0\n"
+            "1000 W IRSA_DHR1 0x0\n"
+            "1000 W IRSA_DHR0 0x2\n"
+            "1000 W IRSA_PFAR0 0xE\n"
+            "1000 W IRSA_CR CR_WRITE16_DHR_TO_CPU_PORT\n"
+            "1000 W IRSA_DHR3 0xC\n"
+            "1000 W IRSA_DHR0 0x0\n"
+            "1000 W IRSA_PFAR0 0xF\n"
+            "1000 W IRSA_CR CR_WRITE16_DHR_TO_CPU_PORT\n"
+            "1000 W IRSA_PFAR0 0xD\n"
+            "1000 W IRSA_CR CR_READ16_CPU_PORT\n"
+            "1000 R 0x1234\n";
+    pass &= text == expected;
+    if(!pass)
+        printf("%s", text.c_str());
+    check("decode", pass);
+    ok &= pass;
+
+    // batched writes are recorded when they are flushed, not when queued
+    MAX1464Trace::clear();
+    max1464.beginBatch();
+    max1464.haltCpu();
+    max1464.writeNibble(0x3, IRSA_PFAR1);
+    pass = MAX1464Trace::count() == 0;
+    hostAdvanceMicros(500);
+    max1464.endBatch();
+    pass &= MAX1464Trace::count() == 2;
+    for(uint8_t i = 0; i < MAX1464Trace::count(); i++)
+        pass &= MAX1464Trace::event(i).timestamp == 1500;
+    pass &= MAX1464Trace::event(1).code == ((0x3 << 4) | IRSA_PFAR1);
+    check("batch-flush", pass);
+    ok &= pass;
+
+    // the ring keeps the last events
+    MAX1464Trace::clear();
+    for(int i = 0; i < 10; i++)
+        max1464.readModuleRegister(R_ADC_CONFIG_1A);
+    pass = MAX1464Trace::count() == MAX1464_TRACE_SIZE;
+    pass &= MAX1464Trace::dropped() > 0;
+    const MAX1464TraceEvent &last =
+            MAX1464Trace::event(MAX1464Trace::count() - 1);
+    pass &= last.type == MAX1464TraceEvent::READ && last.value == 0x1234;
+    check("ring", pass);
+    ok &= pass;
+
+    return ok ? 0 : 1;
+}
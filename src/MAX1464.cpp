@@ -21,15 +21,10 @@
  */
 
 #include "MAX1464.h"
-#include "lib/printhex.h"
-
-using namespace MAX1464_enums;
 
 MAX1464::MAX1464(const int chipSelect) :
-    AbstractMAX1464(chipSelect)
+    AbstractMAX1464(chipSelect), _bus(chipSelect)
 {
-    settings = SPISettings(4000000, LSBFIRST, SPI_MODE0);
-    _3wireMode = false;
 }
 
 /**
@@ -38,58 +33,41 @@ MAX1464::MAX1464(const int chipSelect) :
 
 void MAX1464::begin()
 {
-    SPI.begin();
-    writeNibble(IMR_4WIRE, IRSA_IMR);  // enable 4-wire mode data transfer
+    _bus.begin();
 }
 
 void MAX1464::end()
 {
-    SPI.end();
+    _bus.end();
 }
 
 void MAX1464::byteShiftOut(const uint8_t b, const char *debugMsg) const
 {
+    _bus.byteShiftOut(b);
 #ifdef MAX1464_SERIALDEBUG
-    printHex8(b);
     if(debugMsg != NULL)
         Serial.println(debugMsg);
+#else
+    (void)debugMsg;
 #endif
-    SPI.beginTransaction(settings);
-    digitalWrite(_chipSelect, LOW);
-    SPI.transfer(b);
-    digitalWrite(_chipSelect, HIGH);
-    SPI.endTransaction();
 }
 
-uint16_t MAX1464::wordShiftIn() const
+void MAX1464::bufferShiftOut(const uint8_t *buf, const uint8_t len) const
 {
-    uint16_t w = 0;
-    SPI.beginTransaction(settings);
-    digitalWrite(_chipSelect, LOW);
-
-    w = SPI.transfer16(0x0000);
+    _bus.bufferShiftOut(buf, len);
+}
 
-    digitalWrite(_chipSelect, HIGH);
-    SPI.endTransaction();
+uint16_t MAX1464::wordShiftIn() const
+{
+    return _bus.wordShiftIn();
+}
 
-    // reverse bits
-    uint16_t newVal = 0;
-    if (w & 0x1) newVal |= 0x8000;
-    if (w & 0x2) newVal |= 0x4000;
-    if (w & 0x4) newVal |= 0x2000;
-    if (w & 0x8) newVal |= 0x1000;
-    if (w & 0x10) newVal |= 0x800;
-    if (w & 0x20) newVal |= 0x400;
-    if (w & 0x40) newVal |= 0x200;
-    if (w & 0x80) newVal |= 0x100;
-    if (w & 0x100) newVal |= 0x80;
-    if (w & 0x200) newVal |= 0x40;
-    if (w & 0x400) newVal |= 0x20;
-    if (w & 0x800) newVal |= 0x10;
-    if (w & 0x1000) newVal |= 0x8;
-    if (w & 0x2000) newVal |= 0x4;
-    if (w & 0x4000) newVal |= 0x2;
-    if (w & 0x8000) newVal |= 0x1;
+void MAX1464::setChipSelect(const int chipSelect)
+{
+    _bus.setChipSelect(chipSelect);
+}
 
-    return newVal;
+int MAX1464::chipSelect() const
+{
+    return _bus.chipSelect();
 }
@@ -26,6 +26,39 @@
 #include "lib/AbstractMAX1464.h"
 #include <SPI.h>
 
+/**
+ * @brief SPI bus for MAX1464Core, using the Arduino SPI library with 4-wire
+ * data transfer mode.
+ */
+
+class MAX1464SpiBus
+{
+public:
+    MAX1464SpiBus(const int chipSelect);
+    void begin();
+    void end();
+
+    void byteShiftOut(const uint8_t b) const;
+    void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+    uint16_t wordShiftIn() const;
+    void setChipSelect(const int chipSelect) { _chipSelect = chipSelect; }
+    int chipSelect() const { return _chipSelect; }
+
+protected:
+    int _chipSelect;
+    SPISettings _settings;
+};
+
+/**
+ * @brief Interface to the %MAX1464 through the Arduino SPI library, with the
+ * bus functions inlined.
+ *
+ * Same as MAX1464, without virtual function calls. Cannot be used with the
+ * helpers taking an AbstractMAX1464, such as FlashProgrammer.
+ */
+
+typedef MAX1464Core<MAX1464SpiBus> MAX1464_Inline;
+
 /**
  * @brief Interface to the Maxim %MAX1464 Multichannel Sensor Signal Processor,
  * Arduino SPI library version.
@@ -44,9 +77,111 @@ public:
     virtual void byteShiftOut(
             const uint8_t b, const char *debugMsg = NULL) const;
     virtual uint16_t wordShiftIn() const;
+    virtual void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+    virtual void setChipSelect(const int chipSelect);
+    virtual int chipSelect() const;
 
 private:
-    SPISettings settings;
+    MAX1464SpiBus _bus;
 };
 
+
+
+// MAX1464SpiBus
+
+inline MAX1464SpiBus::MAX1464SpiBus(const int chipSelect) :
+    _settings(4000000, LSBFIRST, SPI_MODE0)
+{
+    _chipSelect = chipSelect;
+    pinMode(_chipSelect, OUTPUT);
+    digitalWrite(_chipSelect, HIGH);
+}
+
+/**
+ * @brief Initialize the SPI bus and enable 4-wire mode data transfer.
+ */
+
+inline void MAX1464SpiBus::begin()
+{
+    SPI.begin();
+    // enable 4-wire mode data transfer
+    byteShiftOut((MAX1464_enums::IMR_4WIRE << 4) | MAX1464_enums::IRSA_IMR);
+}
+
+inline void MAX1464SpiBus::end()
+{
+    SPI.end();
+}
+
+inline void MAX1464SpiBus::byteShiftOut(const uint8_t b) const
+{
+#ifdef MAX1464_SERIALDEBUG
+    printHex8(b);
+#endif
+    SPI.beginTransaction(_settings);
+    digitalWrite(_chipSelect, LOW);
+    SPI.transfer(b);
+    digitalWrite(_chipSelect, HIGH);
+    SPI.endTransaction();
+}
+
+/**
+ * @brief Shift out a sequence of bytes within a single SPI transaction.
+ * @param buf
+ * @param len
+ *
+ * Chip select is still pulsed for every byte, as each byte is a separate
+ * command for the device.
+ */
+
+inline void MAX1464SpiBus::bufferShiftOut(
+        const uint8_t *buf, const uint8_t len) const
+{
+#ifdef MAX1464_SERIALDEBUG
+    for(uint8_t i = 0; i < len; i++)
+        printHex8(buf[i]);
+    Serial.println();
+#endif
+    SPI.beginTransaction(_settings);
+    for(uint8_t i = 0; i < len; i++) {
+        digitalWrite(_chipSelect, LOW);
+        SPI.transfer(buf[i]);
+        digitalWrite(_chipSelect, HIGH);
+    }
+    SPI.endTransaction();
+}
+
+inline uint16_t MAX1464SpiBus::wordShiftIn() const
+{
+    uint16_t w = 0;
+    SPI.beginTransaction(_settings);
+    digitalWrite(_chipSelect, LOW);
+
+    w = SPI.transfer16(0x0000);
+
+    digitalWrite(_chipSelect, HIGH);
+    SPI.endTransaction();
+
+    // reverse bits
+    uint16_t newVal = 0;
+    if (w & 0x1) newVal |= 0x8000;
+    if (w & 0x2) newVal |= 0x4000;
+    if (w & 0x4) newVal |= 0x2000;
+    if (w & 0x8) newVal |= 0x1000;
+    if (w & 0x10) newVal |= 0x800;
+    if (w & 0x20) newVal |= 0x400;
+    if (w & 0x40) newVal |= 0x200;
+    if (w & 0x80) newVal |= 0x100;
+    if (w & 0x100) newVal |= 0x80;
+    if (w & 0x200) newVal |= 0x40;
+    if (w & 0x400) newVal |= 0x20;
+    if (w & 0x800) newVal |= 0x10;
+    if (w & 0x1000) newVal |= 0x8;
+    if (w & 0x2000) newVal |= 0x4;
+    if (w & 0x4000) newVal |= 0x2;
+    if (w & 0x8000) newVal |= 0x1;
+
+    return newVal;
+}
+
 #endif // MAX1464_H
@@ -0,0 +1,40 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ *
+ * Helpers built on AbstractMAX1464, such as FlashProgrammer and AdcScanList.
+ * Include this header next to MAX1464.h, MAX1464_SS.h or
+ * MAX1464_ParallelSS.h to use them.
+ */
+
+#ifndef MAX1464HELPERS_H
+#define MAX1464HELPERS_H
+
+#include "lib/FlashProgrammer.h"
+#include "lib/IncrementalFlashWriter.h"
+#include "lib/FlashVerifier.h"
+#include "lib/MAX1464Group.h"
+#include "lib/FlashScheduler.h"
+#include "lib/AdcAcquisition.h"
+#include "lib/AdcScanList.h"
+#include "lib/ModuleRegisterBank.h"
+#include "lib/CpuProfiler.h"
+
+#endif // MAX1464HELPERS_H
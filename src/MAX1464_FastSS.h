@@ -0,0 +1,232 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464_FASTSS_H
+#define MAX1464_FASTSS_H
+
+#include "lib/MAX1464Core.h"
+#include "lib/MAX1464FastPin.h"
+
+/**
+ * @brief Clock delay policy: toggle SCK as fast as the pins allow.
+ *
+ * On a 16 MHz AVR with compile-time pins SCK stays below 4 MHz.
+ */
+
+struct MAX1464NoDelay
+{
+    static inline void halfClock() {}
+};
+
+/**
+ * @brief Clock delay policy: wait us microseconds on each clock phase.
+ */
+
+template <unsigned int us>
+struct MAX1464DelayMicros
+{
+    static inline void halfClock() { delayMicroseconds(us); }
+};
+
+/**
+ * @brief Software SPI bus with pins selected at compile time.
+ *
+ * Every clock edge is a single write to a port register (see
+ * MAX1464FastPin). If MOSI and MISO are the same pin, the device is used in
+ * 3-wire mode. The Delay policy is called after every clock edge.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay = MAX1464NoDelay>
+class MAX1464FastSoftSpiBus
+{
+public:
+    MAX1464FastSoftSpiBus(const int chipSelect = CS_PIN);
+    void begin();
+    void end() {}
+
+    void byteShiftOut(const uint8_t b) const;
+    void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+    uint16_t wordShiftIn() const;
+
+protected:
+    static const boolean _3wireMode = MOSI_PIN == MISO_PIN;
+
+private:
+    typedef MAX1464FastPin<MOSI_PIN> Mosi;
+    typedef MAX1464FastPin<MISO_PIN> Miso;
+    typedef MAX1464FastPin<SCK_PIN> Sck;
+    typedef MAX1464FastPin<CS_PIN> Cs;
+
+    void clockOut(const uint8_t b) const;
+    uint8_t clockIn() const;
+};
+
+/**
+ * @brief Interface to the %MAX1464 with software SPI on pins selected at
+ * compile time.
+ *
+ * \code
+ * MAX1464_FastSS<11, 12, 13, 10> max1464;  // MOSI, MISO, SCK, CS
+ * MAX1464_FastSS<11, 11, 13, 10, MAX1464DelayMicros<1> > max1464_3wire;
+ * \endcode
+ *
+ * Like MAX1464_SS_Inline, it cannot be used with the helpers taking an
+ * AbstractMAX1464.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay = MAX1464NoDelay>
+using MAX1464_FastSS = MAX1464Core<
+    MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay> >;
+
+
+
+// MAX1464FastSoftSpiBus
+
+/**
+ * @brief Constructor.
+ * @param chipSelect ignored, CS_PIN is used. It is there for MAX1464Core,
+ * which passes its own argument.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay>::
+MAX1464FastSoftSpiBus(const int chipSelect)
+{
+    (void)chipSelect;
+    Cs::init();
+    Cs::output();
+    Cs::high();
+}
+
+/**
+ * @brief Initialize the SPI bus.
+ *
+ * Initializes the SPI pins to outputs, pulling SCK and MOSI low, and SS high.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+void MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay>::begin()
+{
+    Mosi::init();
+    Miso::init();
+    Sck::init();
+    Mosi::output();
+    if(!_3wireMode)
+        Miso::input();
+    Sck::output();
+    Cs::output();
+
+    Mosi::low();
+    Sck::low();
+    Cs::high(); //disable device
+}
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+inline void MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay>::
+byteShiftOut(const uint8_t b) const
+{
+    Sck::low();
+    Cs::low();
+    clockOut(b);
+    Cs::high();
+}
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+void MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay>::
+bufferShiftOut(const uint8_t *buf, const uint8_t len) const
+{
+    for(uint8_t i = 0; i < len; i++)
+        byteShiftOut(buf[i]);
+}
+
+/**
+ * @brief Shift in a word.
+ *
+ * As with MAX1464SoftSpiBus, in 3-wire mode the data line is turned back
+ * into an output right after the read, without restoring its level.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+uint16_t MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay>::
+wordShiftIn() const
+{
+    if(_3wireMode) {
+        byteShiftOut((MAX1464_enums::IMR_3WIRE << 4) | MAX1464_enums::IRSA_IMR);
+        Miso::input();
+    }
+    uint16_t w = 0;
+    Sck::low();
+    Cs::low();
+    w |= clockIn() << 8;
+    w |= clockIn();
+    Cs::high();
+    if(_3wireMode)
+        Mosi::output();
+    return w;
+}
+
+/**
+ * @brief Shift out a byte, LSB first.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+inline void MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN, Delay>::
+clockOut(const uint8_t b) const
+{
+    for(uint8_t mask = 0x01; mask != 0; mask <<= 1) {
+        Mosi::write(b & mask);
+        Sck::high();
+        Delay::halfClock();
+        Sck::low();
+        Delay::halfClock();
+    }
+}
+
+/**
+ * @brief Shift in a byte, MSB first.
+ */
+
+template <uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, uint8_t CS_PIN,
+          class Delay>
+inline uint8_t MAX1464FastSoftSpiBus<MOSI_PIN, MISO_PIN, SCK_PIN, CS_PIN,
+                                     Delay>::clockIn() const
+{
+    uint8_t b = 0;
+    for(uint8_t i = 0; i < 8; i++) {
+        Sck::high();
+        Delay::halfClock();
+        b = (b << 1) | Miso::read();
+        Sck::low();
+        Delay::halfClock();
+    }
+    return b;
+}
+
+#endif // MAX1464_FASTSS_H
@@ -0,0 +1,227 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "MAX1464_ParallelSS.h"
+
+using namespace MAX1464_enums;
+
+/**
+ * @brief Constructor.
+ * @param dataout MOSI, shared by all devices
+ * @param clock SCK, shared by all devices
+ * @param chipSelect chip select of device 0
+ * @param datain MISO line of device 0
+ *
+ * Add the other devices with addDevice().
+ */
+
+MAX1464_ParallelSS::MAX1464_ParallelSS(const int dataout, const int clock,
+                                       const int chipSelect, const int datain) :
+    AbstractMAX1464(chipSelect)
+{
+    _spi_dataout = dataout;
+    _spi_clock = clock;
+    _count = 0;
+#ifdef ARDUINO_ARCH_AVR
+    _dataInPort = NULL;
+#endif
+    memset(_words, 0, sizeof(_words));
+    _captureOut = NULL;
+    _captureIndex = 0;
+    addDevice(chipSelect, datain);
+}
+
+/**
+ * @brief Add a device.
+ * @param chipSelect
+ * @param datain MISO line of the device
+ * @return the index of the device, or -1 if there are already
+ * MAX1464_GROUP_SIZE devices or, on AVR boards, if datain is not on the same
+ * port as the MISO lines of the other devices.
+ */
+
+int8_t MAX1464_ParallelSS::addDevice(const int chipSelect, const int datain)
+{
+    if(_count == MAX1464_GROUP_SIZE)
+        return -1;
+#ifdef ARDUINO_ARCH_AVR
+    volatile uint8_t *port = portInputRegister(digitalPinToPort(datain));
+    if(_count > 0 && port != _dataInPort)
+        return -1;
+    _dataInPort = port;
+    _dataInMasks[_count] = digitalPinToBitMask(datain);
+#else
+    _dataInMasks[_count] = 1 << _count;
+#endif
+    _chipSelects[_count] = chipSelect;
+    _dataIns[_count] = datain;
+    pinMode(chipSelect, OUTPUT);
+    digitalWrite(chipSelect, HIGH);
+    return _count++;
+}
+
+/**
+ * @brief Initialize the SPI pins and enable 4-wire mode on every device.
+ */
+
+void MAX1464_ParallelSS::begin()
+{
+    pinMode(_spi_dataout, OUTPUT);
+    pinMode(_spi_clock, OUTPUT);
+    for(uint8_t i = 0; i < _count; i++)
+        pinMode(_dataIns[i], INPUT);
+
+    digitalWrite(_spi_dataout, LOW);
+    digitalWrite(_spi_clock, LOW);
+    setChipSelects(HIGH);
+    writeNibble(IMR_4WIRE, IRSA_IMR);
+}
+
+void MAX1464_ParallelSS::byteShiftOut(
+        const uint8_t b, const char *debugMsg) const
+{
+#ifdef MAX1464_SERIALDEBUG
+    printHex8(b);
+    if(debugMsg != NULL)
+        Serial.println(debugMsg);
+#else
+    (void)debugMsg;
+#endif
+    setChipSelects(LOW);
+    shiftOut(_spi_dataout, _spi_clock, LSBFIRST, b);
+    setChipSelects(HIGH);
+}
+
+/**
+ * @brief Shift in a word from all devices at once.
+ * @return the word of device 0
+ */
+
+uint16_t MAX1464_ParallelSS::wordShiftIn() const
+{
+    uint8_t samples[16];
+    setChipSelects(LOW);
+    for(uint8_t i = 0; i < 16; i++) {
+        digitalWrite(_spi_clock, HIGH);
+        samples[i] = sampleDataIn();
+        digitalWrite(_spi_clock, LOW);
+    }
+    setChipSelects(HIGH);
+
+    for(uint8_t d = 0; d < _count; d++) {
+        uint16_t w = 0;
+        const uint8_t mask = _dataInMasks[d];
+        for(uint8_t i = 0; i < 16; i++)
+            w = (w << 1) | ((samples[i] & mask) ? 1 : 0);
+        _words[d] = w;
+    }
+    if(_captureOut != NULL) {
+        for(uint8_t d = 1; d < _count; d++)
+            _captureOut[d][_captureIndex] = _words[d] & 0xff;
+        _captureIndex++;
+    }
+    return _words[0];
+}
+
+/**
+ * @brief Word read from a device by the last read operation.
+ * @param device
+ */
+
+uint16_t MAX1464_ParallelSS::lastWord(const uint8_t device) const
+{
+    return device < _count ? _words[device] : 0;
+}
+
+/**
+ * @brief Read a block of flash memory from all devices.
+ * @param partition
+ * @param addr address of the first byte
+ * @param len number of bytes to read
+ * @param out one destination buffer per device, at least len bytes long
+ */
+
+void MAX1464_ParallelSS::readFlashAll(
+        const FLASH_PARTITION partition, const uint16_t addr,
+        const uint16_t len, uint8_t *const *out)
+{
+    _captureOut = out;
+    _captureIndex = 0;
+    readFlash(partition, addr, len, out[0]);
+    _captureOut = NULL;
+}
+
+/**
+ * @brief Compare a block of flash memory of all devices with the expected
+ * contents.
+ * @param partition
+ * @param addr address of the first byte
+ * @param expected
+ * @param len
+ * @return a mask with bit i set if device i differs
+ */
+
+uint8_t MAX1464_ParallelSS::verifyFlash(
+        const FLASH_PARTITION partition, const uint16_t addr,
+        const uint8_t *expected, const uint16_t len)
+{
+    uint8_t temp[MAX1464_GROUP_SIZE][16];
+    uint8_t *out[MAX1464_GROUP_SIZE];
+    for(uint8_t d = 0; d < MAX1464_GROUP_SIZE; d++)
+        out[d] = temp[d];
+    uint8_t mismatch = 0;
+    for(uint16_t offset = 0; offset < len; offset += 16) {
+        uint16_t n = len - offset < 16 ? len - offset : 16;
+        readFlashAll(partition, addr + offset, n, out);
+        for(uint8_t d = 0; d < _count; d++) {
+            if(memcmp(temp[d], expected + offset, n) != 0)
+                mismatch |= 1 << d;
+        }
+    }
+    return mismatch;
+}
+
+void MAX1464_ParallelSS::setChipSelects(const uint8_t level) const
+{
+    for(uint8_t i = 0; i < _count; i++)
+        digitalWrite(_chipSelects[i], level);
+}
+
+/**
+ * @brief Sample all the MISO lines.
+ *
+ * On AVR boards, this is a single read of the port register.
+ */
+
+uint8_t MAX1464_ParallelSS::sampleDataIn() const
+{
+#ifdef ARDUINO_ARCH_AVR
+    return *_dataInPort;
+#else
+    uint8_t sample = 0;
+    for(uint8_t i = 0; i < _count; i++) {
+        if(digitalRead(_dataIns[i]))
+            sample |= _dataInMasks[i];
+    }
+    return sample;
+#endif
+}
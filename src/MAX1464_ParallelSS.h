@@ -0,0 +1,84 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464_PARALLELSS_H
+#define MAX1464_PARALLELSS_H
+
+#include "lib/AbstractMAX1464.h"
+#include "lib/MAX1464Group.h"
+
+/**
+ * @brief Software SPI for up to MAX1464_GROUP_SIZE devices read in parallel.
+ *
+ * The devices share SCK and MOSI; each has its own chip select and MISO
+ * line. All the chip selects are asserted together: writes are broadcast,
+ * and on reads the MISO lines are sampled at once on every clock edge, so
+ * reading the whole fixture takes the time of a single device. On AVR boards
+ * the MISO pins must belong to the same port, which is read with a single
+ * register access per edge.
+ *
+ * The value returned by the read functions, e.g. readModuleRegister(), is
+ * the one of device 0; lastWord() gives the one of every other device.
+ * readFlashAll() and verifyFlash() read a block of flash from all devices.
+ * Only 4-wire mode is supported.
+ */
+
+class MAX1464_ParallelSS : public AbstractMAX1464
+{
+public:
+    MAX1464_ParallelSS(const int dataout, const int clock,
+                       const int chipSelect, const int datain);
+    virtual void begin();
+
+    int8_t addDevice(const int chipSelect, const int datain);
+    uint8_t deviceCount() const { return _count; }
+
+    virtual void byteShiftOut(
+            const uint8_t b, const char *debugMsg = NULL) const;
+    virtual uint16_t wordShiftIn() const;
+    uint16_t lastWord(const uint8_t device) const;
+
+    void readFlashAll(const MAX1464_enums::FLASH_PARTITION partition,
+                      const uint16_t addr, const uint16_t len,
+                      uint8_t *const *out);
+    uint8_t verifyFlash(const MAX1464_enums::FLASH_PARTITION partition,
+                        const uint16_t addr, const uint8_t *expected,
+                        const uint16_t len);
+
+private:
+    void setChipSelects(const uint8_t level) const;
+    uint8_t sampleDataIn() const;
+
+    int _spi_dataout, _spi_clock;
+    int _chipSelects[MAX1464_GROUP_SIZE];
+    int _dataIns[MAX1464_GROUP_SIZE];
+    uint8_t _dataInMasks[MAX1464_GROUP_SIZE];  // bit of each MISO in a sample
+    uint8_t _count;
+#ifdef ARDUINO_ARCH_AVR
+    volatile uint8_t *_dataInPort;
+#endif
+    mutable uint16_t _words[MAX1464_GROUP_SIZE];
+    uint8_t *const *_captureOut;  // see readFlashAll()
+    mutable uint16_t _captureIndex;
+};
+
+#endif // MAX1464_PARALLELSS_H
@@ -21,68 +21,46 @@
  */
 
 #include "MAX1464_SS.h"
-#include "lib/printhex.h"
-
-using namespace MAX1464_enums;
 
 MAX1464_SS::MAX1464_SS(const int chipSelect) :
-    AbstractMAX1464(chipSelect)
+    AbstractMAX1464(chipSelect), _bus(chipSelect)
 {
-    _spi_dataout = 11;
-    _spi_datain = 12;
-    _spi_clock = 13;
 }
 
-/**
- * @brief Initialize the SPI bus.
- *
- * Initializes the specified SPI pins to outputs, pulling SCK and MOSI low, and
- * SS high.
- */
-
 void MAX1464_SS::begin()
 {
-    pinMode(_spi_dataout, OUTPUT);
-    if(!_3wireMode)
-        pinMode(_spi_datain, INPUT);
-    pinMode(_spi_clock, OUTPUT);
-    pinMode(_chipSelect, OUTPUT);
-
-    digitalWrite(_spi_dataout, LOW);
-    digitalWrite(_spi_clock, LOW);
-    digitalWrite(_chipSelect, HIGH); //disable device
+    _bus.begin();
 }
 
 void MAX1464_SS::byteShiftOut(const uint8_t b, const char *debugMsg) const
 {
+    _bus.byteShiftOut(b);
 #ifdef MAX1464_SERIALDEBUG
-    printHex8(b);
     if(debugMsg != NULL)
         Serial.println(debugMsg);
+#else
+    (void)debugMsg;
 #endif
-    digitalWrite(_spi_clock, LOW);
-    digitalWrite(_chipSelect,LOW);
-    shiftOut(_spi_dataout, _spi_clock, LSBFIRST, b);
-    digitalWrite(_chipSelect, HIGH);
+}
+
+void MAX1464_SS::bufferShiftOut(const uint8_t *buf, const uint8_t len) const
+{
+    _bus.bufferShiftOut(buf, len);
 }
 
 uint16_t MAX1464_SS::wordShiftIn() const
 {
-    if(_3wireMode) {
-        writeNibble(IMR_3WIRE, IRSA_IMR);
-        pinMode(_spi_datain, INPUT);
-    }
-    uint16_t w = 0;
-    digitalWrite(_spi_clock, LOW);
-    digitalWrite(_chipSelect, LOW);
-    w |= (shiftIn(_spi_datain, _spi_clock, MSBFIRST) << 8);
-    w |= (shiftIn(_spi_datain, _spi_clock, MSBFIRST));
-    digitalWrite(_chipSelect, HIGH);
-    if(_3wireMode) {
-        pinMode(_spi_dataout, OUTPUT);
-        digitalWrite(_spi_dataout, LOW);
-    }
-    return w;
+    return _bus.wordShiftIn();
+}
+
+void MAX1464_SS::setChipSelect(const int chipSelect)
+{
+    _bus.setChipSelect(chipSelect);
+}
+
+int MAX1464_SS::chipSelect() const
+{
+    return _bus.chipSelect();
 }
 
 /**
@@ -91,18 +69,13 @@ uint16_t MAX1464_SS::wordShiftIn() const
  * @param datain MISO
  * @param clock SCK
  *
- * If dataout and datain are the same pin, the device is configured in 3-wire
- * SPI mode.
+ * If dataout and datain are the same pin, 3-wire SPI is used. The device
+ * goes back to 4-wire mode after every read frame, so 3-wire mode cannot be
+ * set once here: wordShiftIn() selects it again before each word.
  */
 
 void MAX1464_SS::setSpiPins(
         const int dataout, const int datain, const int clock)
 {
-    _spi_datain = datain;
-    _spi_dataout = dataout;
-    _spi_clock = clock;
-    if(_spi_datain == _spi_dataout)
-        _3wireMode = true;
-    else
-        _3wireMode = false;
+    _bus.setSpiPins(dataout, datain, clock);
 }
@@ -25,6 +25,42 @@
 
 #include "lib/AbstractMAX1464.h"
 
+/**
+ * @brief Software SPI bus for MAX1464Core.
+ *
+ * Please specify the SPI pins using setSpiPins().
+ */
+
+class MAX1464SoftSpiBus
+{
+public:
+    MAX1464SoftSpiBus(const int chipSelect);
+    void begin();
+    void end() {}
+
+    void byteShiftOut(const uint8_t b) const;
+    void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+    uint16_t wordShiftIn() const;
+    void setChipSelect(const int chipSelect) { _chipSelect = chipSelect; }
+    int chipSelect() const { return _chipSelect; }
+    void setSpiPins(const int dataout, const int datain, const int clock);
+
+protected:
+    int _chipSelect;
+    boolean _3wireMode;
+    int _spi_dataout, _spi_datain, _spi_clock;
+};
+
+/**
+ * @brief Interface to the %MAX1464 with software SPI, with the bus functions
+ * inlined.
+ *
+ * Same as MAX1464_SS, without virtual function calls. Cannot be used with the
+ * helpers taking an AbstractMAX1464, such as FlashProgrammer.
+ */
+
+typedef MAX1464Core<MAX1464SoftSpiBus> MAX1464_SS_Inline;
+
 /**
  * @brief Interface to the Maxim %MAX1464 Multichannel Sensor Signal Processor,
  * software SPI version.
@@ -42,10 +78,118 @@ public:
     virtual void byteShiftOut(
             const uint8_t b, const char *debugMsg = NULL) const;
     virtual uint16_t wordShiftIn() const;
+    virtual void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+    virtual void setChipSelect(const int chipSelect);
+    virtual int chipSelect() const;
     void setSpiPins(const int dataout, const int datain, const int clock);
 
 private:
-    int _spi_dataout, _spi_datain, _spi_clock;
+    MAX1464SoftSpiBus _bus;
 };
 
+
+
+// MAX1464SoftSpiBus
+
+inline MAX1464SoftSpiBus::MAX1464SoftSpiBus(const int chipSelect)
+{
+    _chipSelect = chipSelect;
+    _3wireMode = true;  // until setSpiPins() is called
+    _spi_dataout = 11;
+    _spi_datain = 12;
+    _spi_clock = 13;
+    pinMode(_chipSelect, OUTPUT);
+    digitalWrite(_chipSelect, HIGH);
+}
+
+/**
+ * @brief Initialize the SPI bus.
+ *
+ * Initializes the specified SPI pins to outputs, pulling SCK and MOSI low, and
+ * SS high.
+ */
+
+inline void MAX1464SoftSpiBus::begin()
+{
+    pinMode(_spi_dataout, OUTPUT);
+    if(!_3wireMode)
+        pinMode(_spi_datain, INPUT);
+    pinMode(_spi_clock, OUTPUT);
+    pinMode(_chipSelect, OUTPUT);
+
+    digitalWrite(_spi_dataout, LOW);
+    digitalWrite(_spi_clock, LOW);
+    digitalWrite(_chipSelect, HIGH); //disable device
+}
+
+inline void MAX1464SoftSpiBus::byteShiftOut(const uint8_t b) const
+{
+#ifdef MAX1464_SERIALDEBUG
+    printHex8(b);
+#endif
+    digitalWrite(_spi_clock, LOW);
+    digitalWrite(_chipSelect,LOW);
+    shiftOut(_spi_dataout, _spi_clock, LSBFIRST, b);
+    digitalWrite(_chipSelect, HIGH);
+}
+
+inline void MAX1464SoftSpiBus::bufferShiftOut(
+        const uint8_t *buf, const uint8_t len) const
+{
+    for(uint8_t i = 0; i < len; i++)
+        byteShiftOut(buf[i]);
+}
+
+/**
+ * @brief Shift in a word.
+ *
+ * In 3-wire mode the device only drives the data line for the frame that
+ * follows an IMR_3WIRE write, then returns to 4-wire mode. The IMR write and
+ * the two direction changes are therefore part of every read; the pin setup
+ * that holds for the whole session is done once, in begin().
+ * The data line is turned back into an output right after the read. Its level
+ * is not restored: the device ignores it while CS is high, and shiftOut()
+ * sets every bit before clocking it.
+ */
+
+inline uint16_t MAX1464SoftSpiBus::wordShiftIn() const
+{
+    if(_3wireMode) {
+        byteShiftOut((MAX1464_enums::IMR_3WIRE << 4) | MAX1464_enums::IRSA_IMR);
+        pinMode(_spi_datain, INPUT);
+    }
+    uint16_t w = 0;
+    digitalWrite(_spi_clock, LOW);
+    digitalWrite(_chipSelect, LOW);
+    w |= (shiftIn(_spi_datain, _spi_clock, MSBFIRST) << 8);
+    w |= (shiftIn(_spi_datain, _spi_clock, MSBFIRST));
+    digitalWrite(_chipSelect, HIGH);
+    if(_3wireMode)
+        pinMode(_spi_dataout, OUTPUT);
+    return w;
+}
+
+/**
+ * @brief Set the pins to be used for SPI communication.
+ * @param dataout MOSI
+ * @param datain MISO
+ * @param clock SCK
+ *
+ * If dataout and datain are the same pin, 3-wire SPI is used. The device
+ * goes back to 4-wire mode after every read frame, so 3-wire mode cannot be
+ * set once here: wordShiftIn() selects it again before each word.
+ */
+
+inline void MAX1464SoftSpiBus::setSpiPins(
+        const int dataout, const int datain, const int clock)
+{
+    _spi_datain = datain;
+    _spi_dataout = dataout;
+    _spi_clock = clock;
+    if(_spi_datain == _spi_dataout)
+        _3wireMode = true;
+    else
+        _3wireMode = false;
+}
+
 #endif // MAX1464_SS_H
@@ -19,29 +19,20 @@
 #ifndef ABSTRACTMAX1464_H
 #define ABSTRACTMAX1464_H
 
-#include <Arduino.h>
-#include "MAX1464_enums.h"
-
-//#define MAX1464_SERIALDEBUG
+#include "MAX1464Core.h"
 
 /**
  * \file
  */
 
 /**
- * @brief The AbstractMAX1464 class provides a complete interface to the Maxim
- * %MAX1464 Multichannel Sensor Signal Processor.
- *
- * The serial communication details are left unimplemented. The MAX1464 class
- * makes use of the Arduino SPI library, whereas the MAX1464_SS class
- * implements SPI in software.
+ * @brief Bus with virtual functions, on which AbstractMAX1464 is built.
  */
 
-class AbstractMAX1464
+class AbstractMAX1464Bus
 {
-
 public:
-    AbstractMAX1464(const int chipSelect = 10);
+    AbstractMAX1464Bus(const int chipSelect);
     /**
      * @brief Initialize the SPI bus.
      *
@@ -50,59 +41,33 @@ public:
     virtual void begin() {}
     virtual void end() {}
 
-    // simple CR functions
-    void haltCpu() const;
-    void resetCpu() const;
-    void releaseCpu() const;
-    void eraseFlashMemory() const;
-    void eraseFlashPartition(
-            const MAX1464_enums::FLASH_PARTITION partition) const;
-    void copyFlashToDhr() const;
-    void singleStepCpu() const;
-
-    // IRSA functions
-    void setFlashAddress(const uint16_t addr) const;
-    void writeDHR(const uint16_t data) const;
-    void writeDHRLSB(const uint8_t data) const;
-    void writeCR(const MAX1464_enums::CR_COMMAND cmd) const;
-    void writeNibble(
-            const uint8_t nibble, const MAX1464_enums::IRSA irsa) const;
-
-    // Flash memory
-    void beginWritingToFlashPartition(const MAX1464_enums::FLASH_PARTITION partition) const;
-    boolean writeHexLineToFlashMemory(const String hexline);
-    void readFlashPartition(
-            const MAX1464_enums::FLASH_PARTITION partition
-            = MAX1464_enums::PARTITION_0) const;
-    void writeByteToFlash(const uint8_t value, const uint16_t addr) const;
-    boolean hasEOFBeenReached() const;
-
-    // CPU ports
-    uint16_t readCpuPort(const MAX1464_enums::CPU_PORT port) const;
-    void writeCpuPort(
-            const uint16_t word, const MAX1464_enums::CPU_PORT port) const;
-
-    // module registers
-    void writeModuleRegister(const uint16_t data,
-                             const MAX1464_enums::MODULE_REGISTER_ADDRESS addr
-                             ) const;
-    uint16_t readModuleRegister(
-            const MAX1464_enums::MODULE_REGISTER_ADDRESS addr) const;
-
-    // CPU registers
-    uint16_t readCpuAccumulatorRegister() const;
-    uint16_t readCpuProgramCounter() const;
-
     virtual void byteShiftOut(
             const uint8_t b, const char *debugMsg = NULL) const = 0;
     virtual uint16_t wordShiftIn() const = 0;
+    virtual void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+    virtual void setChipSelect(const int chipSelect);
+    virtual int chipSelect() const;
+};
 
-private:
-    boolean EOFReached;
+extern template class MAX1464Core<AbstractMAX1464Bus>;
 
-protected:
-    int _chipSelect;
-    boolean _3wireMode;
+/**
+ * @brief The AbstractMAX1464 class provides a complete interface to the Maxim
+ * %MAX1464 Multichannel Sensor Signal Processor.
+ *
+ * The serial communication details are left unimplemented. The MAX1464 class
+ * makes use of the Arduino SPI library, whereas the MAX1464_SS class
+ * implements SPI in software.
+ *
+ * Every byte goes through a virtual function call. See MAX1464Core for
+ * drivers whose transport is selected at compile time.
+ */
+
+class AbstractMAX1464 : public MAX1464Core<AbstractMAX1464Bus>
+{
+public:
+    AbstractMAX1464(const int chipSelect = 10) :
+        MAX1464Core<AbstractMAX1464Bus>(chipSelect) {}
 };
 
 
@@ -0,0 +1,171 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "AdcAcquisition.h"
+
+using namespace MAX1464_enums;
+
+#define BUFFER_MASK (MAX1464_ADC_BUFFER_SIZE - 1)
+
+AdcAcquisition::AdcAcquisition(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _control = 0;
+    _period = 0;
+    _next = 0;
+    _triggered = 0;
+    _running = false;
+    _converting = false;
+    _head = 0;
+    _tail = 0;
+    _samples = 0;
+    _overruns = 0;
+    _missedTicks = 0;
+}
+
+/**
+ * @brief Start the acquisition.
+ * @param control the value written to ADC_CONTROL to start a conversion: a
+ * combination of CNVT_ADC_1, CNVT_ADC_2 and CNVT_ADC_T, with a CNVT_SE_*
+ * input selection if needed
+ * @param periodMicros
+ *
+ * The first conversion is started right away. The buffer and the counters
+ * are cleared.
+ */
+
+void AdcAcquisition::begin(const uint16_t control,
+                           const unsigned long periodMicros)
+{
+    _control = control;
+    _period = periodMicros;
+    _head = 0;
+    _tail = 0;
+    _samples = 0;
+    _overruns = 0;
+    _missedTicks = 0;
+    _converting = false;
+    _running = true;
+    _next = micros();
+    poll();
+}
+
+/**
+ * @brief Stop the acquisition.
+ *
+ * The result of the conversion in progress is discarded; samples already in
+ * the buffer can still be read.
+ */
+
+void AdcAcquisition::end()
+{
+    _running = false;
+    _converting = false;
+}
+
+/**
+ * @brief Collect the last conversion and start the next one, if it is time.
+ * @return true if a conversion was started
+ */
+
+boolean AdcAcquisition::poll()
+{
+    if(!_running)
+        return false;
+    const unsigned long now = micros();
+    if((long)(now - _next) < 0)
+        return false;
+
+    if(_converting) {
+        const uint8_t head = _head;
+        if(((head + 1) & BUFFER_MASK) == _tail) {
+            _overruns++;
+        }
+        else {
+            AdcSample &sample = _buffer[head];
+            sample.timestamp = _triggered;
+            readResults(sample);
+            _head = (head + 1) & BUFFER_MASK;
+            _samples++;
+        }
+    }
+
+    _triggered = micros();
+    _max1464.writeModuleRegister(_control, R_ADC_CONTROL);
+    _converting = true;
+
+    // keep to the schedule, skipping the ticks that were missed
+    _next += _period;
+    if((long)(now - _next) >= 0) {
+        const unsigned long missed = (now - _next) / _period + 1;
+        _missedTicks += missed;
+        _next += missed * _period;
+    }
+    return true;
+}
+
+/**
+ * @brief Number of samples that can be read.
+ */
+
+uint8_t AdcAcquisition::available() const
+{
+    return (_head - _tail) & BUFFER_MASK;
+}
+
+/**
+ * @brief Take the oldest sample from the buffer.
+ * @param sample
+ * @return false if the buffer is empty
+ */
+
+boolean AdcAcquisition::read(AdcSample &sample)
+{
+    const uint8_t tail = _tail;
+    if(tail == _head)
+        return false;
+    sample = _buffer[tail];
+    _tail = (tail + 1) & BUFFER_MASK;
+    return true;
+}
+
+/**
+ * @brief Discard all the samples in the buffer.
+ */
+
+void AdcAcquisition::clear()
+{
+    _tail = _head;
+}
+
+void AdcAcquisition::readResults(AdcSample &sample) const
+{
+    sample.adc1 = 0;
+    sample.adc2 = 0;
+    sample.adcT = 0;
+    if(_control & CNVT_ADC_1)
+        sample.adc1 = _max1464.readModuleRegister(R_ADC_DATA_1);
+    if(_control & CNVT_ADC_2)
+        sample.adc2 = _max1464.readModuleRegister(R_ADC_DATA_2);
+    if(_control & CNVT_ADC_T)
+        sample.adcT = _max1464.readModuleRegister(R_ADC_DATA_T);
+}
@@ -0,0 +1,122 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef ADCACQUISITION_H
+#define ADCACQUISITION_H
+
+#include "AbstractMAX1464.h"
+
+#ifndef MAX1464_ADC_BUFFER_SIZE
+/**
+ * @brief Number of samples held by AdcAcquisition.
+ *
+ * Must be a power of two, not larger than 128.
+ */
+#define MAX1464_ADC_BUFFER_SIZE 16
+#endif
+
+#if (MAX1464_ADC_BUFFER_SIZE & (MAX1464_ADC_BUFFER_SIZE - 1)) != 0 \
+    || MAX1464_ADC_BUFFER_SIZE > 128
+#error "MAX1464_ADC_BUFFER_SIZE must be a power of two not larger than 128"
+#endif
+
+/**
+ * @brief Results of one conversion of the acquired channels.
+ *
+ * Channels that are not acquired read 0.
+ */
+
+struct AdcSample
+{
+    /// micros() when the conversion was started; it lags the tick by the
+    /// poll() latency
+    unsigned long timestamp;
+    uint16_t adc1;
+    uint16_t adc2;
+    uint16_t adcT;
+};
+
+/**
+ * @brief Paced ADC acquisition.
+ *
+ * Conversions are started by writing the ADC_CONTROL bits given to begin()
+ * at a fixed period. Each time, the results of the previous conversion are
+ * read first, so the period must be longer than the conversion time set in
+ * the ADC_CONFIG registers. Ticks follow a fixed schedule, independent of
+ * when poll() is called; ticks that are missed because poll() was called too
+ * late are skipped and counted.
+ *
+ * Samples are stored in a ring buffer. When it is full, new samples are
+ * dropped and counted as overruns.
+ *
+ * poll() must be called from the main loop, never from an interrupt: it
+ * talks to the device through the same driver as the rest of the sketch,
+ * and the driver's batch buffer, register cache and chip select cannot be
+ * shared with an interrupted transfer.
+ * \code
+ * AdcAcquisition adc(max1464);
+ * adc.begin(CNVT_ADC_1 | CNVT_ADC_T, 1000); // every 1 ms
+ * ...
+ * void loop() {
+ *     adc.poll();
+ *     AdcSample s;
+ *     while(adc.read(s))
+ *         ... // s.timestamp, s.adc1, s.adcT
+ * }
+ * \endcode
+ *
+ * \pre CPU must be halted, so that it does not use the module registers.
+ */
+
+class AdcAcquisition
+{
+public:
+    AdcAcquisition(const AbstractMAX1464 &max1464);
+
+    void begin(const uint16_t control, const unsigned long periodMicros);
+    void end();
+    boolean poll();
+
+    uint8_t available() const;
+    boolean read(AdcSample &sample);
+    void clear();
+
+    unsigned long periodMicros() const { return _period; }
+    unsigned long samples() const { return _samples; }
+    unsigned long overruns() const { return _overruns; }
+    unsigned long missedTicks() const { return _missedTicks; }
+
+private:
+    void readResults(AdcSample &sample) const;
+
+    const AbstractMAX1464 &_max1464;
+    uint16_t _control;
+    unsigned long _period;
+    unsigned long _next;
+    unsigned long _triggered;  // timestamp of the conversion in progress
+    boolean _running, _converting;
+    AdcSample _buffer[MAX1464_ADC_BUFFER_SIZE];
+    uint8_t _head, _tail;  // written by poll(), read()
+    unsigned long _samples, _overruns, _missedTicks;
+};
+
+#endif // ADCACQUISITION_H
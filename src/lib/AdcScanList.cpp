@@ -0,0 +1,168 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "AdcScanList.h"
+
+using namespace MAX1464_enums;
+
+#define WRITE_CONFIG_A 0x01
+#define WRITE_CONFIG_B 0x02
+
+/**
+ * @brief Index of the ADC converting in a step: 0 for ADC_1, 1 for ADC_2, 2
+ * for ADC_T, -1 if the step does not start exactly one conversion.
+ */
+
+static int8_t adcIndex(const uint16_t control)
+{
+    switch(control & (CNVT_ADC_1 | CNVT_ADC_2 | CNVT_ADC_T)) {
+    case CNVT_ADC_1:
+        return 0;
+    case CNVT_ADC_2:
+        return 1;
+    case CNVT_ADC_T:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+// ADC_CONFIG_nA, ADC_CONFIG_nB and ADC_DATA_n are consecutive for each ADC
+static MODULE_REGISTER_ADDRESS dataRegister(const int8_t adc)
+{
+    return (MODULE_REGISTER_ADDRESS)(R_ADC_DATA_1 + 3 * adc);
+}
+
+static MODULE_REGISTER_ADDRESS configRegister(const int8_t adc,
+                                              const uint8_t b)
+{
+    return (MODULE_REGISTER_ADDRESS)(R_ADC_CONFIG_1A + 3 * adc + b);
+}
+
+AdcScanList::AdcScanList(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _steps = NULL;
+    _count = 0;
+    _conversionMicros = 0;
+    _cycles = 0;
+}
+
+/**
+ * @brief Set the list and prepare the configuration registers.
+ * @param steps must stay valid while the list is used
+ * @param count
+ * @param conversionMicros time to wait for each conversion, depending on the
+ * clock and resolution set in ADC_CONFIG_nA
+ * @return false if the list is too long or a step does not select exactly
+ * one ADC
+ */
+
+boolean AdcScanList::begin(const AdcScanStep *steps, const uint8_t count,
+                           const unsigned long conversionMicros)
+{
+    // a rejected list must not leave the previous one running
+    _steps = NULL;
+    _count = 0;
+    if(count > MAX1464_SCAN_LIST_SIZE)
+        return false;
+    for(uint8_t i = 0; i < count; i++) {
+        if(adcIndex(steps[i].control) < 0)
+            return false;
+    }
+    _steps = steps;
+    _count = count;
+    _conversionMicros = conversionMicros;
+    _cycles = 0;
+
+    // register contents at the end of a cycle, which is where each cycle
+    // starts from
+    uint16_t config[3][2];
+    uint8_t used = 0;  // bit 2 * adc + b
+    for(uint8_t i = 0; i < count; i++) {
+        int8_t adc = adcIndex(steps[i].control);
+        config[adc][0] = steps[i].configA;
+        config[adc][1] = steps[i].configB;
+        used |= 3 << (2 * adc);
+    }
+
+    _max1464.beginBatch();
+    for(int8_t adc = 0; adc < 3; adc++) {
+        for(uint8_t b = 0; b < 2; b++) {
+            if(used & (1 << (2 * adc + b)))
+                _max1464.writeModuleRegister(config[adc][b],
+                                             configRegister(adc, b));
+        }
+    }
+    _max1464.endBatch();
+
+    for(uint8_t i = 0; i < count; i++) {
+        int8_t adc = adcIndex(steps[i].control);
+        _writes[i] = 0;
+        if(config[adc][0] != steps[i].configA)
+            _writes[i] |= WRITE_CONFIG_A;
+        if(config[adc][1] != steps[i].configB)
+            _writes[i] |= WRITE_CONFIG_B;
+        config[adc][0] = steps[i].configA;
+        config[adc][1] = steps[i].configB;
+    }
+    return true;
+}
+
+/**
+ * @brief Run one cycle of the list.
+ * @param results one word per step, can be NULL
+ */
+
+void AdcScanList::scan(uint16_t *results)
+{
+    for(uint8_t i = 0; i < _count; i++) {
+        const AdcScanStep &step = _steps[i];
+        const int8_t adc = adcIndex(step.control);
+        _max1464.beginBatch();
+        if(_writes[i] & WRITE_CONFIG_A)
+            _max1464.writeModuleRegister(step.configA, configRegister(adc, 0));
+        if(_writes[i] & WRITE_CONFIG_B)
+            _max1464.writeModuleRegister(step.configB, configRegister(adc, 1));
+        _max1464.writeModuleRegister(step.control, R_ADC_CONTROL);
+        _max1464.endBatch();
+        if(_conversionMicros >= 1000)
+            delay(_conversionMicros / 1000);
+        delayMicroseconds(_conversionMicros % 1000);
+        uint16_t data = _max1464.readModuleRegister(dataRegister(adc));
+        if(results != NULL)
+            results[i] = data;
+    }
+    _cycles++;
+}
+
+/**
+ * @brief Number of configuration registers written by each call to scan().
+ */
+
+uint8_t AdcScanList::configWritesPerCycle() const
+{
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < _count; i++)
+        n += (_writes[i] & 1) + ((_writes[i] >> 1) & 1);
+    return n;
+}
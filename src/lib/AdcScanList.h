@@ -0,0 +1,95 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef ADCSCANLIST_H
+#define ADCSCANLIST_H
+
+#include "AbstractMAX1464.h"
+
+#ifndef MAX1464_SCAN_LIST_SIZE
+/**
+ * @brief Maximum number of steps in an AdcScanList.
+ */
+#define MAX1464_SCAN_LIST_SIZE 8
+#endif
+
+/**
+ * @brief One conversion of an AdcScanList.
+ */
+
+struct AdcScanStep
+{
+    /**
+     * @brief Value written to ADC_CONTROL: exactly one of CNVT_ADC_1,
+     * CNVT_ADC_2 and CNVT_ADC_T, with a CNVT_SE_* input selection if needed.
+     */
+    uint16_t control;
+    uint16_t configA;  ///< ADC_CONFIG_nA of the converting ADC
+    uint16_t configB;  ///< ADC_CONFIG_nB of the converting ADC
+};
+
+/**
+ * @brief Cyclic scan of ADC channels with their own configuration.
+ *
+ * The configuration registers written at each step are computed once in
+ * begin(): a register is only written if the previous step of the cycle
+ * left a different value in it. begin() itself writes the registers the
+ * list uses with the values found at the end of a cycle, so that the first
+ * cycle starts from the same state as all the others.
+ * \code
+ * static const AdcScanStep steps[] = {
+ *     {CNVT_ADC_1, CONFIGA_PGA_GAIN_31 | CONFIGA_RES_16BIT, CONFIGB_REF_VDD},
+ *     {CNVT_ADC_T, CONFIGA_RES_12BIT, CONFIGB_REF_VDD},
+ *     {CNVT_ADC_1 | CNVT_SE_VDD, CONFIGA_RES_12BIT, CONFIGB_REF_VDD},
+ * };
+ * AdcScanList scan(max1464);
+ * scan.begin(steps, 3, 2000); // 2 ms per conversion
+ * uint16_t results[3];
+ * scan.scan(results);
+ * \endcode
+ *
+ * \pre CPU must be halted, so that it does not use the module registers.
+ */
+
+class AdcScanList
+{
+public:
+    AdcScanList(const AbstractMAX1464 &max1464);
+
+    boolean begin(const AdcScanStep *steps, const uint8_t count,
+                  const unsigned long conversionMicros);
+    void scan(uint16_t *results);
+
+    uint8_t stepCount() const { return _count; }
+    uint8_t configWritesPerCycle() const;
+    unsigned long cycles() const { return _cycles; }
+
+private:
+    const AbstractMAX1464 &_max1464;
+    const AdcScanStep *_steps;
+    uint8_t _count;
+    unsigned long _conversionMicros;
+    uint8_t _writes[MAX1464_SCAN_LIST_SIZE];  // bit 0: config A, 1: config B
+    unsigned long _cycles;
+};
+
+#endif // ADCSCANLIST_H
@@ -0,0 +1,217 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "CpuProfiler.h"
+
+CpuProfiler::CpuProfiler(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _period = 0;
+    _jitter = 0;
+    _tick = 0;
+    _next = 0;
+    _start = 0;
+    _random = 0x12345678;
+    _first = 0;
+    _last = MAX1464_PARTITION_0_SIZE - 1;
+    _shift = 0;
+    _running = false;
+    clear();
+}
+
+/**
+ * @brief Start sampling.
+ * @param periodMicros mean time between two samples
+ * @param jitterMicros maximum deviation from the period, at most half of it
+ * @param firstAddr first flash address covered by the histogram
+ * @param lastAddr last flash address covered by the histogram
+ *
+ * The histogram and the counters are cleared. Program counters outside
+ * [firstAddr, lastAddr] are counted by outOfRange().
+ */
+
+void CpuProfiler::begin(const unsigned long periodMicros,
+                        const unsigned long jitterMicros,
+                        const uint16_t firstAddr, const uint16_t lastAddr)
+{
+    _period = periodMicros;
+    _jitter = jitterMicros > periodMicros / 2 ? periodMicros / 2
+                                              : jitterMicros;
+    _first = firstAddr;
+    _last = lastAddr < firstAddr ? firstAddr : lastAddr;
+    _shift = 0;
+    while(((uint32_t)(_last - _first) >> _shift) >= MAX1464_PROFILER_BINS)
+        _shift++;
+    clear();
+    _tick = _start + _period;
+    _next = _tick + nextOffset();
+    _running = true;
+}
+
+/**
+ * @brief Take a sample, if it is time.
+ * @return true if a sample was taken
+ *
+ * A sample that is due is taken once, however late poll() is called.
+ */
+
+boolean CpuProfiler::poll()
+{
+    if(!_running)
+        return false;
+    const unsigned long now = micros();
+    if((long)(now - _next) < 0)
+        return false;
+    sample();
+
+    // keep to the schedule, skipping the periods that were missed
+    _tick += _period;
+    if((long)(now - _tick) >= 0)
+        _tick += ((now - _tick) / _period + 1) * _period;
+    _next = _tick + nextOffset();
+    return true;
+}
+
+/**
+ * @brief Halt the CPU, read the program counter and release the CPU.
+ * @return false if the program counter is outside the histogram
+ */
+
+boolean CpuProfiler::sample()
+{
+    const unsigned long t0 = micros();
+    _max1464.beginBatch();
+    _max1464.haltCpu();
+    const uint16_t pc = _max1464.readCpuProgramCounter();
+    _max1464.releaseCpu();
+    _max1464.endBatch();
+    const unsigned long dt = micros() - t0;
+
+    _overhead += dt;
+    if(dt > _maxOverhead)
+        _maxOverhead = dt;
+    _lastPc = pc;
+    _samples++;
+    const int16_t bin = binOf(pc);
+    if(bin < 0) {
+        _outOfRange++;
+        return false;
+    }
+    if(_bins[bin] != 0xffff)
+        _bins[bin]++;
+    return true;
+}
+
+/**
+ * @brief Clear the histogram and the counters.
+ */
+
+void CpuProfiler::clear()
+{
+    memset(_bins, 0, sizeof(_bins));
+    _lastPc = 0;
+    _samples = 0;
+    _outOfRange = 0;
+    _overhead = 0;
+    _maxOverhead = 0;
+    _start = micros();
+}
+
+/**
+ * @brief First flash address counted in a bin.
+ */
+
+uint16_t CpuProfiler::binAddress(const uint8_t bin) const
+{
+    return _first + ((uint16_t)bin << _shift);
+}
+
+/**
+ * @brief Bin counting a program counter, or -1 if it is out of range.
+ */
+
+int16_t CpuProfiler::binOf(const uint16_t pc) const
+{
+    if(pc < _first || pc > _last)
+        return -1;
+    return (pc - _first) >> _shift;
+}
+
+/**
+ * @brief Time since begin() or clear().
+ */
+
+unsigned long CpuProfiler::elapsedMicros() const
+{
+    return micros() - _start;
+}
+
+/**
+ * @brief Print the non-empty bins and the overhead.
+ * @param out
+ *
+ * Each bin is printed as "<first address>-<last address> <count>", in hex.
+ * The overhead is the time the CPU was kept halted, in total and per sample,
+ * and as a fraction of the elapsed time in parts per million.
+ */
+
+void CpuProfiler::print(Print &out) const
+{
+    for(uint8_t b = 0; b < MAX1464_PROFILER_BINS; b++) {
+        if(_bins[b] == 0)
+            continue;
+        const uint16_t addr = binAddress(b);
+        out.print(addr, HEX);
+        out.print('-');
+        out.print(addr + binWidth() - 1, HEX);
+        out.print(' ');
+        out.println(_bins[b]);
+    }
+    out.print("samples ");
+    out.println(_samples);
+    out.print("out of range ");
+    out.println(_outOfRange);
+    out.print("overhead us ");
+    out.print(_overhead);
+    out.print(" max ");
+    out.print(_maxOverhead);
+    out.print(" mean ");
+    out.println(_samples ? (double)_overhead / _samples : 0.0, 2);
+    out.print("overhead ppm ");
+    const unsigned long elapsed = elapsedMicros();
+    out.println(elapsed ? (unsigned long)(1e6 * _overhead / elapsed) : 0UL);
+}
+
+/**
+ * @brief Time of the next sample relative to the start of its period, drawn
+ * uniformly from [-jitter, +jitter] with a xorshift generator.
+ */
+
+unsigned long CpuProfiler::nextOffset()
+{
+    if(_jitter == 0)
+        return 0;
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return (_random % (2 * _jitter + 1)) - _jitter;
+}
@@ -0,0 +1,103 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef CPUPROFILER_H
+#define CPUPROFILER_H
+
+#include "AbstractMAX1464.h"
+
+#ifndef MAX1464_PROFILER_BINS
+/**
+ * @brief Number of bins of the CpuProfiler histogram.
+ */
+#define MAX1464_PROFILER_BINS 64
+#endif
+
+/**
+ * @brief Statistical profiler of the firmware running on the %MAX1464.
+ *
+ * At a jittered period, poll() halts the CPU, reads the program counter and
+ * releases the CPU again, with the three commands batched so that the CPU
+ * stays halted for two bus transfers only. The program counters are counted
+ * in a histogram covering the flash addresses given to begin(); each bin
+ * covers binWidth() addresses, a power of two. The jitter keeps the samples
+ * from locking to loops whose period is a multiple of the sampling period.
+ *
+ * The time the CPU is kept halted is measured with micros() and reported by
+ * overheadMicros(), so that the perturbation of the firmware can be judged.
+ * \code
+ * CpuProfiler profiler(max1464);
+ * profiler.begin(1000, 250); // every 750-1250 us
+ * ...
+ * profiler.poll(); // in loop()
+ * ...
+ * profiler.print(Serial);
+ * \endcode
+ */
+
+class CpuProfiler
+{
+public:
+    CpuProfiler(const AbstractMAX1464 &max1464);
+
+    void begin(const unsigned long periodMicros,
+               const unsigned long jitterMicros = 0,
+               const uint16_t firstAddr = 0,
+               const uint16_t lastAddr = MAX1464_PARTITION_0_SIZE - 1);
+    void end() { _running = false; }
+    boolean poll();
+    boolean sample();
+    void clear();
+
+    uint16_t binCount(const uint8_t bin) const { return _bins[bin]; }
+    uint16_t binAddress(const uint8_t bin) const;
+    uint16_t binWidth() const { return 1 << _shift; }
+    int16_t binOf(const uint16_t pc) const;
+
+    unsigned long samples() const { return _samples; }
+    unsigned long outOfRange() const { return _outOfRange; }
+    unsigned long overheadMicros() const { return _overhead; }
+    unsigned long maxOverheadMicros() const { return _maxOverhead; }
+    unsigned long elapsedMicros() const;
+    uint16_t lastProgramCounter() const { return _lastPc; }
+
+    void print(Print &out) const;
+
+private:
+    unsigned long nextOffset();
+
+    const AbstractMAX1464 &_max1464;
+    unsigned long _period, _jitter;
+    unsigned long _tick;  // start of the current period
+    unsigned long _next;  // time of the next sample
+    unsigned long _start;
+    uint32_t _random;
+    uint16_t _first, _last;
+    uint8_t _shift;
+    boolean _running;
+    uint16_t _bins[MAX1464_PROFILER_BINS];
+    uint16_t _lastPc;
+    unsigned long _samples, _outOfRange;
+    unsigned long _overhead, _maxOverhead;
+};
+
+#endif // CPUPROFILER_H
@@ -0,0 +1,179 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "FlashProgrammer.h"
+
+using namespace MAX1464_enums;
+
+#define QUEUE_MASK (MAX1464_PROGRAMMER_QUEUE_SIZE - 1)
+
+FlashProgrammer::FlashProgrammer(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _head = 0;
+    _count = 0;
+    _busy = false;
+    _EOFReached = false;
+    _start = 0;
+    _duration = 0;
+    _bytesWritten = 0;
+}
+
+/**
+ * @brief Start a flash cycle.
+ * @param partition
+ * @return false if a previous operation is still in progress
+ *
+ * Halts the CPU, disables all analog modules and starts erasing the selected
+ * partition, like AbstractMAX1464::beginWritingToFlashPartition(), but
+ * without waiting for the erase to complete. Bytes can be fed right away.
+ *
+ * \warning The selected partition will be erased.
+ */
+
+boolean FlashProgrammer::begin(const FLASH_PARTITION partition)
+{
+    if(!isIdle())
+        return false;
+    _max1464.prepareForFlashing();
+    _EOFReached = false;
+    _bytesWritten = 0;
+    return erase(partition);
+}
+
+/**
+ * @brief Start erasing a partition.
+ * @param partition
+ * @return false if a previous operation is still in progress
+ *
+ * \pre CPU must be halted.
+ */
+
+boolean FlashProgrammer::erase(const FLASH_PARTITION partition)
+{
+    if(!isIdle())
+        return false;
+    _max1464.startErasingFlashPartition(partition);
+    _max1464.flushBatch();
+    startDeadline(MAX1464_FLASH_ERASE_TIME_MS * 1000UL);
+    return true;
+}
+
+/**
+ * @brief Queue a byte for programming.
+ * @param value
+ * @param addr
+ * @return false if the queue is full
+ */
+
+boolean FlashProgrammer::feed(const uint8_t value, const uint16_t addr)
+{
+    if(_count == MAX1464_PROGRAMMER_QUEUE_SIZE)
+        return false;
+    uint8_t tail = (_head + _count) & QUEUE_MASK;
+    _values[tail] = value;
+    _addresses[tail] = addr;
+    _count++;
+    return true;
+}
+
+/**
+ * @brief Queue the data of a HEX record for programming.
+ * @param record a parser whose last status is HEX_RECORD_READY
+ * @return false if the record is not valid or if there is not enough room in
+ * the queue for the whole record; in the latter case nothing is queued and
+ * the call can be retried after poll().
+ */
+
+boolean FlashProgrammer::feed(const IntelHexParser &record)
+{
+    if(record.status() != IntelHexParser::HEX_RECORD_READY)
+        return false;
+    if(record.recordType() == IntelHexParser::RECORD_EOF) {
+        _EOFReached = true;
+        return true;
+    }
+    if(record.byteCount() > queueSpace())
+        return false;
+    uint16_t addr = record.address();
+    for(uint8_t i = 0; i < record.byteCount(); i++)
+        feed(record.data()[i], addr++);
+    return true;
+}
+
+/**
+ * @brief Advance the programming engine.
+ * @return true if a byte was sent to the device
+ *
+ * If the previous erase or write has completed and a byte is queued, the
+ * commands to program it are sent and the function returns without waiting.
+ */
+
+boolean FlashProgrammer::poll()
+{
+    if(isBusy())
+        return false;
+    _busy = false;
+    while(_count != 0) {
+        boolean sent = _max1464.startWritingByteToFlash(
+                    _values[_head], _addresses[_head]);
+        _head = (_head + 1) & QUEUE_MASK;
+        _count--;
+        _bytesWritten++;
+        if(sent) {  // skipped bytes need no wait
+            _max1464.flushBatch();
+            startDeadline(MAX1464_FLASH_WRITE_TIME_US);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Whether all queued bytes have been programmed.
+ */
+
+boolean FlashProgrammer::isIdle() const
+{
+    return _count == 0 && !isBusy();
+}
+
+/**
+ * @brief Number of bytes that can still be queued.
+ */
+
+uint8_t FlashProgrammer::queueSpace() const
+{
+    return MAX1464_PROGRAMMER_QUEUE_SIZE - _count;
+}
+
+boolean FlashProgrammer::isBusy() const
+{
+    return _busy && micros() - _start < _duration;
+}
+
+void FlashProgrammer::startDeadline(const unsigned long us)
+{
+    _busy = true;
+    _start = micros();
+    _duration = us + MAX1464_MICROS_RESOLUTION;
+}
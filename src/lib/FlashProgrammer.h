@@ -0,0 +1,120 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef FLASHPROGRAMMER_H
+#define FLASHPROGRAMMER_H
+
+#include "AbstractMAX1464.h"
+
+#ifndef MAX1464_PROGRAMMER_QUEUE_SIZE
+/**
+ * @brief Number of bytes that can be queued for programming.
+ *
+ * Must be a power of two, at least as large as MAX1464_HEX_MAX_DATA.
+ */
+#define MAX1464_PROGRAMMER_QUEUE_SIZE 32
+#endif
+
+#if MAX1464_PROGRAMMER_QUEUE_SIZE < MAX1464_HEX_MAX_DATA
+#error "MAX1464_PROGRAMMER_QUEUE_SIZE must not be smaller than MAX1464_HEX_MAX_DATA"
+#endif
+
+static_assert((MAX1464_PROGRAMMER_QUEUE_SIZE
+               & (MAX1464_PROGRAMMER_QUEUE_SIZE - 1)) == 0,
+              "MAX1464_PROGRAMMER_QUEUE_SIZE must be a power of two");
+
+#ifndef MAX1464_MICROS_RESOLUTION
+/**
+ * @brief Resolution of micros(), in microseconds.
+ *
+ * Added to every programming and erase wait, so that a wait never ends early
+ * because of the granularity of micros(). On AVR, micros() counts in steps of
+ * 64 clock cycles: 4 us at 16 MHz, 8 us at 8 MHz.
+ */
+#if defined(F_CPU) && F_CPU < 64000000UL
+#define MAX1464_MICROS_RESOLUTION (64000000UL / F_CPU)
+#elif defined(F_CPU)
+#define MAX1464_MICROS_RESOLUTION 1
+#else
+#define MAX1464_MICROS_RESOLUTION 8
+#endif
+#endif
+
+/**
+ * @brief Non-blocking flash programming engine.
+ *
+ * Instead of waiting after every erase and byte write, the engine records a
+ * deadline with micros() and returns to the caller, which can receive and
+ * parse the next HEX line in the meantime. Bytes are queued with feed() and
+ * programmed by poll(), which must be called frequently:
+ * \code
+ * FlashProgrammer programmer(max1464);
+ * programmer.begin(PARTITION_0);
+ * ...
+ * void loop() {
+ *     programmer.poll();
+ *     if(parser.feed(Serial.read()) == IntelHexParser::HEX_RECORD_READY)
+ *         while(!programmer.feed(parser))
+ *             programmer.poll();
+ * }
+ * \endcode
+ */
+
+class FlashProgrammer
+{
+public:
+    FlashProgrammer(const AbstractMAX1464 &max1464);
+
+    boolean begin(const MAX1464_enums::FLASH_PARTITION partition);
+    boolean erase(const MAX1464_enums::FLASH_PARTITION partition);
+    boolean feed(const uint8_t value, const uint16_t addr);
+    boolean feed(const IntelHexParser &record);
+    boolean poll();
+    boolean isIdle() const;
+
+    uint8_t queueSpace() const;
+    boolean hasEOFBeenReached() const { return _EOFReached; }
+    /**
+     * @brief Number of bytes dequeued since begin(), including those skipped
+     * by AbstractMAX1464::setSkipErasedBytes().
+     */
+    unsigned long bytesWritten() const { return _bytesWritten; }
+    /**
+     * @brief The device being programmed.
+     */
+    const AbstractMAX1464 &device() const { return _max1464; }
+
+private:
+    boolean isBusy() const;
+    void startDeadline(const unsigned long us);
+
+    const AbstractMAX1464 &_max1464;
+    uint8_t _values[MAX1464_PROGRAMMER_QUEUE_SIZE];
+    uint16_t _addresses[MAX1464_PROGRAMMER_QUEUE_SIZE];
+    uint8_t _head, _count;
+    boolean _busy;
+    boolean _EOFReached;
+    unsigned long _start, _duration;
+    unsigned long _bytesWritten;
+};
+
+#endif // FLASHPROGRAMMER_H
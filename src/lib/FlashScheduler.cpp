@@ -0,0 +1,243 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "FlashScheduler.h"
+
+using namespace MAX1464_enums;
+
+FlashScheduler::FlashScheduler()
+{
+    _count = 0;
+    _running = false;
+    _start = 0;
+    _elapsed = 0;
+}
+
+/**
+ * @brief Add a device.
+ * @param programmer the programming engine of the device
+ * @return the index of the device, or -1 if there is no room
+ */
+
+int8_t FlashScheduler::addDevice(FlashProgrammer &programmer)
+{
+    if(_count == MAX1464_SCHEDULER_SIZE)
+        return -1;
+    Job &job = _jobs[_count];
+    job.programmer = &programmer;
+    job.partition = PARTITION_0;
+    job.addr = 0;
+    job.data = NULL;
+    job.len = 0;
+    job.fed = 0;
+    job.writes = NULL;
+    job.writeCount = 0;
+    job.written = 0;
+    return _count++;
+}
+
+/**
+ * @brief Set the image to be flashed to a device.
+ * @param device
+ * @param partition the partition is erased by begin()
+ * @param addr address of the first byte
+ * @param data must stay valid until the device is done
+ * @param len
+ * @return false if there is no such device
+ */
+
+boolean FlashScheduler::setImage(const uint8_t device,
+                                 const FLASH_PARTITION partition,
+                                 const uint16_t addr, const uint8_t *data,
+                                 const uint16_t len)
+{
+    if(device >= _count)
+        return false;
+    Job &job = _jobs[device];
+    job.partition = partition;
+    job.addr = addr;
+    job.data = data;
+    job.len = len;
+    return true;
+}
+
+/**
+ * @brief Set the module registers to be written to a device after its image.
+ * @param device
+ * @param writes must stay valid until the device is done
+ * @param count
+ * @return false if there is no such device
+ */
+
+boolean FlashScheduler::setRegisterWrites(const uint8_t device,
+                                          const MAX1464RegisterWrite *writes,
+                                          const uint8_t count)
+{
+    if(device >= _count)
+        return false;
+    _jobs[device].writes = writes;
+    _jobs[device].writeCount = count;
+    return true;
+}
+
+/**
+ * @brief Start all the jobs.
+ * @return false if a programmer is still busy
+ *
+ * The partitions of the devices that have an image are erased, all at the
+ * same time.
+ */
+
+boolean FlashScheduler::begin()
+{
+    for(uint8_t i = 0; i < _count; i++) {
+        if(!_jobs[i].programmer->isIdle())
+            return false;
+    }
+    for(uint8_t i = 0; i < _count; i++) {
+        Job &job = _jobs[i];
+        job.fed = 0;
+        job.written = 0;
+        if(job.data != NULL)
+            job.programmer->begin(job.partition);
+    }
+    _running = true;
+    _start = micros();
+    _elapsed = 0;
+    return true;
+}
+
+/**
+ * @brief Advance all the jobs.
+ * @return true while there is work left
+ */
+
+boolean FlashScheduler::poll()
+{
+    if(!_running)
+        return false;
+    boolean pending = false;
+    for(uint8_t i = 0; i < _count; i++)
+        pending |= pollJob(_jobs[i]);
+    if(!pending) {
+        _running = false;
+        _elapsed = micros() - _start;
+    }
+    return pending;
+}
+
+/**
+ * @brief Whether all the jobs started by begin() are complete.
+ */
+
+boolean FlashScheduler::isDone() const
+{
+    return !_running;
+}
+
+/**
+ * @brief Number of bytes of its image programmed into a device.
+ * @param device
+ */
+
+uint16_t FlashScheduler::bytesWritten(const uint8_t device) const
+{
+    if(device >= _count || _jobs[device].data == NULL)
+        return 0;
+    return _jobs[device].programmer->bytesWritten();
+}
+
+/**
+ * @brief Progress of a device, in percent.
+ * @param device
+ *
+ * Image bytes and register writes count the same.
+ */
+
+uint8_t FlashScheduler::progress(const uint8_t device) const
+{
+    if(device >= _count)
+        return 0;
+    const Job &job = _jobs[device];
+    const uint32_t total = (uint32_t)job.len + job.writeCount;
+    if(total == 0)
+        return 100;
+    return (uint32_t)(bytesWritten(device) + job.written) * 100 / total;
+}
+
+/**
+ * @brief Number of image bytes programmed into all the devices.
+ */
+
+unsigned long FlashScheduler::totalBytesWritten() const
+{
+    unsigned long total = 0;
+    for(uint8_t i = 0; i < _count; i++)
+        total += bytesWritten(i);
+    return total;
+}
+
+/**
+ * @brief Time since begin(), or time taken by the last run if done.
+ */
+
+unsigned long FlashScheduler::elapsedMicros() const
+{
+    return _running ? micros() - _start : _elapsed;
+}
+
+/**
+ * @brief Aggregate programming throughput, in bytes per second.
+ */
+
+unsigned long FlashScheduler::bytesPerSecond() const
+{
+    const unsigned long us = elapsedMicros();
+    if(us == 0)
+        return 0;
+    return (unsigned long long)totalBytesWritten() * 1000000UL / us;
+}
+
+/**
+ * @brief Give a device its turn on the bus.
+ * @return true if the device has work left
+ */
+
+boolean FlashScheduler::pollJob(Job &job)
+{
+    FlashProgrammer &programmer = *job.programmer;
+    if(job.data != NULL) {
+        while(job.fed < job.len && programmer.queueSpace() > 0) {
+            programmer.feed(job.data[job.fed], job.addr + job.fed);
+            job.fed++;
+        }
+    }
+    programmer.poll();
+    if(!programmer.isIdle() || (job.data != NULL && job.fed < job.len))
+        return true;
+    if(job.written < job.writeCount) {
+        const MAX1464RegisterWrite &w = job.writes[job.written++];
+        programmer.device().writeModuleRegister(w.data, w.addr);
+        return job.written < job.writeCount;
+    }
+    return false;
+}
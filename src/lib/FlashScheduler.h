@@ -0,0 +1,113 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef FLASHSCHEDULER_H
+#define FLASHSCHEDULER_H
+
+#include "FlashProgrammer.h"
+
+#ifndef MAX1464_SCHEDULER_SIZE
+/**
+ * @brief Maximum number of devices handled by a FlashScheduler.
+ */
+#define MAX1464_SCHEDULER_SIZE 8
+#endif
+
+/**
+ * @brief A module register write, see FlashScheduler::setRegisterWrites().
+ */
+
+struct MAX1464RegisterWrite
+{
+    uint16_t data;
+    MAX1464_enums::MODULE_REGISTER_ADDRESS addr;
+};
+
+/**
+ * @brief Flash several devices on the same bus at once.
+ *
+ * Each device is driven by its own FlashProgrammer. On every poll() the
+ * scheduler goes round all the devices, refilling their queues and sending
+ * the next byte to those that are not busy, so that the bus is used for one
+ * device while the others are erasing or programming. Once its image has
+ * been written, each device gets its list of module register writes.
+ *
+ * \code
+ * FlashProgrammer p0(max1464_0), p1(max1464_1);
+ * FlashScheduler scheduler;
+ * scheduler.addDevice(p0);
+ * scheduler.addDevice(p1);
+ * scheduler.setImage(0, PARTITION_0, 0, image0, sizeof(image0));
+ * scheduler.setImage(1, PARTITION_0, 0, image1, sizeof(image1));
+ * scheduler.begin();
+ * while(scheduler.poll())
+ *     ;  // or do something else
+ * \endcode
+ */
+
+class FlashScheduler
+{
+public:
+    FlashScheduler();
+
+    int8_t addDevice(FlashProgrammer &programmer);
+    uint8_t deviceCount() const { return _count; }
+    boolean setImage(const uint8_t device,
+                     const MAX1464_enums::FLASH_PARTITION partition,
+                     const uint16_t addr, const uint8_t *data,
+                     const uint16_t len);
+    boolean setRegisterWrites(const uint8_t device,
+                              const MAX1464RegisterWrite *writes,
+                              const uint8_t count);
+
+    boolean begin();
+    boolean poll();
+    boolean isDone() const;
+
+    uint16_t bytesWritten(const uint8_t device) const;
+    uint8_t progress(const uint8_t device) const;
+    unsigned long totalBytesWritten() const;
+    unsigned long elapsedMicros() const;
+    unsigned long bytesPerSecond() const;
+
+private:
+    struct Job {
+        FlashProgrammer *programmer;
+        MAX1464_enums::FLASH_PARTITION partition;
+        uint16_t addr;
+        const uint8_t *data;
+        uint16_t len;
+        uint16_t fed;
+        const MAX1464RegisterWrite *writes;
+        uint8_t writeCount;
+        uint8_t written;
+    };
+
+    boolean pollJob(Job &job);
+
+    Job _jobs[MAX1464_SCHEDULER_SIZE];
+    uint8_t _count;
+    boolean _running;
+    unsigned long _start, _elapsed;
+};
+
+#endif // FLASHSCHEDULER_H
@@ -0,0 +1,253 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "FlashVerifier.h"
+
+using namespace MAX1464_enums;
+
+#define ADLER32_MOD 65521UL
+
+// the per-byte updates in write() stay below the modulus
+static_assert(0xffUL * MAX1464_FLASH_PAGE_SIZE < ADLER32_MOD,
+              "flash page too large");
+
+/**
+ * @brief Fold the Adler sums of a page into those of the whole partition.
+ * @param a running sum of the bytes, starts at 1
+ * @param b running sum of the a values, starts at the partition size
+ * @param pageA sum of the bytes of the page
+ * @param pageB sum of the bytes of the page, each weighted by the number of
+ * bytes from it to the end of the page
+ * @param following number of bytes after the page in the partition
+ */
+
+static void addPage(uint32_t &a, uint32_t &b, const uint16_t pageA,
+                    const uint16_t pageB, const uint16_t following)
+{
+    a = (a + pageA) % ADLER32_MOD;
+    b = (b + pageB + following * (uint32_t)pageA) % ADLER32_MOD;
+}
+
+FlashVerifier::FlashVerifier(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _checksumPort = CPU_PORT_0;
+    _runTimeMs = 0;
+    _useChecksumPort = false;
+    begin(PARTITION_0);
+}
+
+/**
+ * @brief Read the checksum computed by the firmware.
+ * @param port the first of the two CPU ports where the firmware publishes
+ * the checksum
+ * @param runTimeMs time the firmware needs to compute it after a reset
+ * @return false if port is the last CPU port
+ *
+ * The firmware must compute the Adler-32 of the partition being verified and
+ * write its low word (the byte sum) to port and its high word to the next
+ * port.
+ */
+
+boolean FlashVerifier::setChecksumPort(const CPU_PORT port,
+                                       const unsigned long runTimeMs)
+{
+    if(port >= CPU_PORT_F)
+        return false;
+    _checksumPort = port;
+    _runTimeMs = runTimeMs;
+    _useChecksumPort = true;
+    return true;
+}
+
+/**
+ * @brief Always verify by reading back the partition.
+ */
+
+void FlashVerifier::clearChecksumPort()
+{
+    _useChecksumPort = false;
+}
+
+/**
+ * @brief Start collecting the expected image.
+ * @param partition
+ */
+
+void FlashVerifier::begin(const FLASH_PARTITION partition)
+{
+    // sums of a blank page
+    const uint16_t blankA = 0xffUL * MAX1464_FLASH_PAGE_SIZE % ADLER32_MOD;
+    const uint16_t blankB = 0xffUL * MAX1464_FLASH_PAGE_SIZE
+            * (MAX1464_FLASH_PAGE_SIZE + 1) / 2 % ADLER32_MOD;
+    _partition = partition;
+    for(uint8_t p = 0; p < MAX1464_FLASH_PAGES; p++) {
+        _pageSumsA[p] = blankA;
+        _pageSumsB[p] = blankB;
+    }
+    memset(_mismatched, 0, sizeof(_mismatched));
+    _pagesMismatched = 0;
+    _deviceChecksum = 0;
+    _readBack = false;
+}
+
+/**
+ * @brief Add data to the expected image.
+ * @param addr
+ * @param data
+ * @param len
+ * @return false if the data does not fit in the partition
+ *
+ * Each address must be written at most once.
+ */
+
+boolean FlashVerifier::write(const uint16_t addr, const uint8_t *data,
+                             const uint8_t len)
+{
+    if((uint32_t)addr + len > (uint32_t)pageCount() * MAX1464_FLASH_PAGE_SIZE)
+        return false;
+    for(uint8_t i = 0; i < len; i++) {  // replaces a blank byte
+        const uint8_t p = (addr + i) / MAX1464_FLASH_PAGE_SIZE;
+        const uint8_t weight =
+                MAX1464_FLASH_PAGE_SIZE - (addr + i) % MAX1464_FLASH_PAGE_SIZE;
+        const uint8_t d = 0xff - data[i];
+        _pageSumsA[p] = (_pageSumsA[p] + ADLER32_MOD - d) % ADLER32_MOD;
+        _pageSumsB[p] = (_pageSumsB[p] + ADLER32_MOD - (uint16_t)weight * d)
+                % ADLER32_MOD;
+    }
+    return true;
+}
+
+/**
+ * @brief Add a HEX record to the expected image.
+ * @param record a parser whose last status is HEX_RECORD_READY
+ * @return false if the record is not valid or does not fit in the partition
+ */
+
+boolean FlashVerifier::writeHexRecord(const IntelHexParser &record)
+{
+    if(record.status() != IntelHexParser::HEX_RECORD_READY)
+        return false;
+    if(record.recordType() == IntelHexParser::RECORD_EOF)
+        return true;
+    return write(record.address(), record.data(), record.byteCount());
+}
+
+/**
+ * @brief Check the device contents against the expected image.
+ * @return true if they match
+ *
+ * If a checksum port has been set, the CPU is reset and run for the given
+ * time, then halted and the checksum is read from the ports. The partition
+ * is read back only if there is no checksum port or the checksum differs.
+ *
+ * \post CPU is halted.
+ */
+
+boolean FlashVerifier::verify()
+{
+    memset(_mismatched, 0, sizeof(_mismatched));
+    _pagesMismatched = 0;
+    _readBack = false;
+
+    if(_useChecksumPort) {
+        _max1464.resetCpu();
+        _max1464.flushBatch();
+        delay(_runTimeMs);
+        _max1464.haltCpu();
+        _deviceChecksum = _max1464.readCpuPort(_checksumPort);
+        _deviceChecksum |= (uint32_t)_max1464.readCpuPort(
+                    (CPU_PORT)(_checksumPort + 1)) << 16;
+        if(_deviceChecksum == checksum())
+            return true;
+    }
+    else {
+        _max1464.haltCpu();
+    }
+
+    _readBack = true;
+    const uint16_t size = pageCount() * MAX1464_FLASH_PAGE_SIZE;
+    uint32_t a = 1;
+    uint32_t b = size;
+    uint8_t temp[16];
+    for(uint8_t p = 0; p < pageCount(); p++) {
+        uint32_t pageA = 0;
+        uint32_t pageB = 0;
+        for(uint8_t offset = 0; offset < MAX1464_FLASH_PAGE_SIZE;
+            offset += sizeof(temp)) {
+            _max1464.readFlash(_partition,
+                               p * MAX1464_FLASH_PAGE_SIZE + offset,
+                               sizeof(temp), temp);
+            for(uint8_t j = 0; j < sizeof(temp); j++) {
+                pageA += temp[j];
+                pageB += (uint32_t)(MAX1464_FLASH_PAGE_SIZE - offset - j)
+                        * temp[j];
+            }
+        }
+        pageA %= ADLER32_MOD;
+        pageB %= ADLER32_MOD;
+        addPage(a, b, pageA, pageB,
+                size - (p + 1) * MAX1464_FLASH_PAGE_SIZE);
+        if(pageA != _pageSumsA[p] || pageB != _pageSumsB[p]) {
+            _mismatched[p >> 3] |= 1 << (p & 7);
+            _pagesMismatched++;
+        }
+    }
+    _deviceChecksum = b << 16 | a;
+    return _pagesMismatched == 0;
+}
+
+/**
+ * @brief Expected Adler-32 of the partition.
+ */
+
+uint32_t FlashVerifier::checksum() const
+{
+    const uint16_t size = pageCount() * MAX1464_FLASH_PAGE_SIZE;
+    uint32_t a = 1;
+    uint32_t b = size;
+    for(uint8_t p = 0; p < pageCount(); p++)
+        addPage(a, b, _pageSumsA[p], _pageSumsB[p],
+                size - (p + 1) * MAX1464_FLASH_PAGE_SIZE);
+    return b << 16 | a;
+}
+
+/**
+ * @brief Whether a page differs from the expected image.
+ * @param page
+ *
+ * Only meaningful after a verify() that read back the partition.
+ */
+
+boolean FlashVerifier::isPageMismatched(const uint8_t page) const
+{
+    if(page >= MAX1464_FLASH_PAGES)
+        return false;
+    return _mismatched[page >> 3] & (1 << (page & 7));
+}
+
+uint8_t FlashVerifier::pageCount() const
+{
+    return _partition == PARTITION_1
+            ? MAX1464_PARTITION_1_SIZE / MAX1464_FLASH_PAGE_SIZE
+            : MAX1464_FLASH_PAGES;
+}
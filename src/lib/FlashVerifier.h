@@ -0,0 +1,89 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef FLASHVERIFIER_H
+#define FLASHVERIFIER_H
+
+#include "IncrementalFlashWriter.h"
+
+/**
+ * @brief Post-flash verification by checksum.
+ *
+ * The expected image is passed with write() or writeHexRecord(), as when
+ * flashing it, in any order. Bytes that the image does not cover are
+ * considered blank (0xFF). The checksum of the partition is its Adler-32:
+ * unlike a plain sum, it changes when bytes are swapped or land at the wrong
+ * address. Only the two Adler sums of each page are kept, since a byte's
+ * contribution to them depends on its offset alone.
+ *
+ * If the firmware computes this checksum itself and publishes it on two CPU
+ * ports (see setChecksumPort()), verify() runs the CPU and reads two words
+ * back. Otherwise, or if the checksum does not match, the partition is read
+ * back page by page to find the pages that differ:
+ * \code
+ * FlashVerifier verifier(max1464);
+ * verifier.setChecksumPort(CPU_PORT_E, 10);
+ * verifier.begin(PARTITION_0);
+ * verifier.writeHexRecord(parser); // for every parsed record
+ * if(!verifier.verify())
+ *     ... // see isPageMismatched()
+ * \endcode
+ */
+
+class FlashVerifier
+{
+public:
+    FlashVerifier(const AbstractMAX1464 &max1464);
+
+    boolean setChecksumPort(const MAX1464_enums::CPU_PORT port,
+                         const unsigned long runTimeMs);
+    void clearChecksumPort();
+
+    void begin(const MAX1464_enums::FLASH_PARTITION partition);
+    boolean write(const uint16_t addr, const uint8_t *data,
+                  const uint8_t len);
+    boolean writeHexRecord(const IntelHexParser &record);
+    boolean verify();
+
+    uint32_t checksum() const;
+    uint32_t deviceChecksum() const { return _deviceChecksum; }
+    boolean hasReadBack() const { return _readBack; }
+    uint8_t pagesMismatched() const { return _pagesMismatched; }
+    boolean isPageMismatched(const uint8_t page) const;
+
+private:
+    uint8_t pageCount() const;
+
+    const AbstractMAX1464 &_max1464;
+    MAX1464_enums::FLASH_PARTITION _partition;
+    MAX1464_enums::CPU_PORT _checksumPort;
+    unsigned long _runTimeMs;
+    boolean _useChecksumPort;
+    uint16_t _pageSumsA[MAX1464_FLASH_PAGES];
+    uint16_t _pageSumsB[MAX1464_FLASH_PAGES];
+    uint8_t _mismatched[(MAX1464_FLASH_PAGES + 7) / 8];
+    uint8_t _pagesMismatched;
+    uint32_t _deviceChecksum;
+    boolean _readBack;
+};
+
+#endif // FLASHVERIFIER_H
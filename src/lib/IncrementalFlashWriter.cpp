@@ -0,0 +1,210 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "IncrementalFlashWriter.h"
+
+using namespace MAX1464_enums;
+
+IncrementalFlashWriter::IncrementalFlashWriter(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _partition = PARTITION_0;
+    _fingerprints = NULL;
+    _page = -1;
+    memset(_visited, 0, sizeof(_visited));
+    _pagesErased = _pagesPatched = _pagesSkipped = 0;
+    _bytesWritten = 0;
+    _EOFReached = false;
+}
+
+/**
+ * @brief Start an update.
+ * @param partition
+ * @param fingerprints optional table with one entry per page of the
+ * partition, holding the pageFingerprint() of the device contents. The table
+ * is updated as pages are written and can be kept for the next update.
+ *
+ * Halts the CPU and disables all analog modules. Nothing is erased.
+ */
+
+void IncrementalFlashWriter::begin(const FLASH_PARTITION partition,
+                                   uint16_t *fingerprints)
+{
+    _partition = partition;
+    _fingerprints = fingerprints;
+    _page = -1;
+    memset(_visited, 0, sizeof(_visited));
+    _pagesErased = _pagesPatched = _pagesSkipped = 0;
+    _bytesWritten = 0;
+    _EOFReached = false;
+    _max1464.prepareForFlashing();
+}
+
+/**
+ * @brief Add data to the new image.
+ * @param addr
+ * @param data
+ * @param len
+ * @return false if the data does not fit in the partition
+ */
+
+boolean IncrementalFlashWriter::write(const uint16_t addr, const uint8_t *data,
+                                      const uint8_t len)
+{
+    if((uint32_t)addr + len > partitionSize())
+        return false;
+    for(uint8_t i = 0; i < len; i++) {
+        uint16_t a = addr + i;
+        uint8_t page = a / MAX1464_FLASH_PAGE_SIZE;
+        if(page != _page) {
+            commitPage();
+            openPage(page);
+        }
+        _buffer[a % MAX1464_FLASH_PAGE_SIZE] = data[i];
+    }
+    return true;
+}
+
+/**
+ * @brief Add a HEX record to the new image.
+ * @param record a parser whose last status is HEX_RECORD_READY
+ * @return false if the record is not valid or does not fit in the partition
+ *
+ * The EOF record calls end().
+ */
+
+boolean IncrementalFlashWriter::writeHexRecord(const IntelHexParser &record)
+{
+    if(record.status() != IntelHexParser::HEX_RECORD_READY)
+        return false;
+    if(record.recordType() == IntelHexParser::RECORD_EOF) {
+        end();
+        _EOFReached = true;
+        return true;
+    }
+    return write(record.address(), record.data(), record.byteCount());
+}
+
+/**
+ * @brief Write the last pending page to the device.
+ */
+
+void IncrementalFlashWriter::end()
+{
+    commitPage();
+}
+
+/**
+ * @brief CRC-16/CCITT of a flash page.
+ * @param page MAX1464_FLASH_PAGE_SIZE bytes
+ */
+
+uint16_t IncrementalFlashWriter::pageFingerprint(const uint8_t *page)
+{
+    uint16_t crc = 0xffff;
+    for(uint8_t i = 0; i < MAX1464_FLASH_PAGE_SIZE; i++) {
+        crc ^= page[i] << 8;
+        for(uint8_t b = 0; b < 8; b++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+void IncrementalFlashWriter::openPage(const uint8_t page)
+{
+    const uint8_t mask = 1 << (page & 7);
+    if(_visited[page >> 3] & mask)  // merge with what was already written
+        _max1464.readFlash(_partition, page * MAX1464_FLASH_PAGE_SIZE,
+                           MAX1464_FLASH_PAGE_SIZE, _buffer);
+    else
+        memset(_buffer, 0xff, sizeof(_buffer));
+    _visited[page >> 3] |= mask;
+    _page = page;
+}
+
+void IncrementalFlashWriter::commitPage()
+{
+    if(_page < 0)
+        return;
+    const uint16_t base = _page * MAX1464_FLASH_PAGE_SIZE;
+    uint16_t fingerprint = 0;
+    if(_fingerprints != NULL) {
+        fingerprint = pageFingerprint(_buffer);
+        if(_fingerprints[_page] == fingerprint) {
+            _pagesSkipped++;
+            _page = -1;
+            return;
+        }
+    }
+
+    // compare with the device contents
+    uint8_t changed[MAX1464_FLASH_PAGE_SIZE / 8];
+    memset(changed, 0, sizeof(changed));
+    boolean differs = false, needsErase = false;
+    uint8_t temp[16];
+    for(uint8_t offset = 0; offset < MAX1464_FLASH_PAGE_SIZE; offset += 16) {
+        _max1464.readFlash(_partition, base + offset, 16, temp);
+        for(uint8_t j = 0; j < 16; j++) {
+            const uint8_t i = offset + j;
+            if(temp[j] == _buffer[i])
+                continue;
+            differs = true;
+            changed[i >> 3] |= 1 << (i & 7);
+            // programming can only clear bits
+            if((temp[j] & _buffer[i]) != _buffer[i])
+                needsErase = true;
+        }
+    }
+
+    if(!differs) {
+        _pagesSkipped++;
+    }
+    else if(needsErase) {
+        _max1464.eraseFlashPage(_partition, base);
+        for(uint8_t i = 0; i < MAX1464_FLASH_PAGE_SIZE; i++) {
+            if(_buffer[i] == 0xff)
+                continue;
+            _max1464.writeByteToFlash(_buffer[i], base + i);
+            _bytesWritten++;
+        }
+        _pagesErased++;
+    }
+    else {
+        for(uint8_t i = 0; i < MAX1464_FLASH_PAGE_SIZE; i++) {
+            if(!(changed[i >> 3] & (1 << (i & 7))))
+                continue;
+            _max1464.writeByteToFlash(_buffer[i], base + i);
+            _bytesWritten++;
+        }
+        _pagesPatched++;
+    }
+
+    if(_fingerprints != NULL)
+        _fingerprints[_page] = fingerprint;
+    _page = -1;
+}
+
+uint16_t IncrementalFlashWriter::partitionSize() const
+{
+    return _partition == PARTITION_1 ? MAX1464_PARTITION_1_SIZE
+                                     : MAX1464_PARTITION_0_SIZE;
+}
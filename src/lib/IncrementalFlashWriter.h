@@ -0,0 +1,92 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef INCREMENTALFLASHWRITER_H
+#define INCREMENTALFLASHWRITER_H
+
+#include "AbstractMAX1464.h"
+
+/**
+ * @brief Number of pages in partition 0.
+ */
+#define MAX1464_FLASH_PAGES (MAX1464_PARTITION_0_SIZE / MAX1464_FLASH_PAGE_SIZE)
+
+/**
+ * @brief Differential flash update.
+ *
+ * The new image is assembled one page at a time. When a page is complete, it
+ * is compared with the device contents and:
+ * - if it is identical, nothing is sent to the device;
+ * - if the changed bytes only clear bits, they are programmed without
+ *   erasing;
+ * - otherwise the page is erased and its non-blank bytes are programmed.
+ *
+ * The comparison can be skipped altogether by keeping a table of page
+ * fingerprints (see pageFingerprint()) from the previous update: pages whose
+ * fingerprint did not change are not even read back.
+ *
+ * Pages that do not appear in the new image are left untouched. Bytes of a
+ * page that the image does not cover are considered blank (0xFF), as after a
+ * full erase.
+ *
+ * Records should be written in ascending address order; when an image
+ * revisits a page that has already been written, the page is reloaded from
+ * the device and merged.
+ */
+
+class IncrementalFlashWriter
+{
+public:
+    IncrementalFlashWriter(const AbstractMAX1464 &max1464);
+
+    void begin(const MAX1464_enums::FLASH_PARTITION partition,
+               uint16_t *fingerprints = NULL);
+    boolean write(const uint16_t addr, const uint8_t *data,
+                  const uint8_t len);
+    boolean writeHexRecord(const IntelHexParser &record);
+    void end();
+
+    uint8_t pagesErased() const { return _pagesErased; }
+    uint8_t pagesPatched() const { return _pagesPatched; }
+    uint8_t pagesSkipped() const { return _pagesSkipped; }
+    uint16_t bytesWritten() const { return _bytesWritten; }
+    boolean hasEOFBeenReached() const { return _EOFReached; }
+
+    static uint16_t pageFingerprint(const uint8_t *page);
+
+private:
+    void openPage(const uint8_t page);
+    void commitPage();
+    uint16_t partitionSize() const;
+
+    const AbstractMAX1464 &_max1464;
+    MAX1464_enums::FLASH_PARTITION _partition;
+    uint16_t *_fingerprints;
+    uint8_t _buffer[MAX1464_FLASH_PAGE_SIZE];
+    int8_t _page;                      // page in _buffer, -1 if none
+    uint8_t _visited[(MAX1464_FLASH_PAGES + 7) / 8];
+    uint8_t _pagesErased, _pagesPatched, _pagesSkipped;
+    uint16_t _bytesWritten;
+    boolean _EOFReached;
+};
+
+#endif // INCREMENTALFLASHWRITER_H
@@ -0,0 +1,170 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "IntelHexParser.h"
+
+// record layout: count, address MSB, address LSB, type, data..., checksum
+#define HEADER_SIZE 4
+
+static inline boolean isLineEnd(const char c)
+{
+    return c == '\n' || c == '\r';
+}
+
+static inline boolean isBlank(const char c)
+{
+    return c == ' ' || c == '\t' || isLineEnd(c);
+}
+
+static inline int8_t hexDigitValue(const char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+IntelHexParser::IntelHexParser()
+{
+    reset();
+}
+
+/**
+ * @brief Discard any partially parsed record.
+ */
+
+void IntelHexParser::reset()
+{
+    _state = STATE_START;
+    _status = HEX_INCOMPLETE;
+    _index = 0;
+    _highNibble = 0;
+    _haveHighNibble = false;
+    _sum = 0;
+    _byteCount = 0;
+    _address = 0;
+    _recordType = 0;
+}
+
+/**
+ * @brief Parse one character.
+ * @param c
+ * @return HEX_RECORD_READY when c completes a valid record, one of the error
+ * codes if the record is illegal, HEX_INCOMPLETE otherwise.
+ */
+
+IntelHexParser::Status IntelHexParser::feed(const char c)
+{
+    switch(_state) {
+    case STATE_SKIP_LINE:
+        if(isLineEnd(c))
+            _state = STATE_START;
+        return _status = HEX_INCOMPLETE;
+
+    case STATE_START:
+        if(isBlank(c))
+            return _status = HEX_INCOMPLETE;
+        if(c != ':')
+            return fail(HEX_ERR_START_CODE, c);
+        _state = STATE_FIELDS;
+        _index = 0;
+        _sum = 0;
+        _haveHighNibble = false;
+        return _status = HEX_INCOMPLETE;
+
+    default: {
+        int8_t v = hexDigitValue(c);
+        if(v < 0)
+            return fail(isLineEnd(c) ? HEX_ERR_TRUNCATED : HEX_ERR_DIGIT, c);
+        if(!_haveHighNibble) {
+            _highNibble = v;
+            _haveHighNibble = true;
+            return _status = HEX_INCOMPLETE;
+        }
+        _haveHighNibble = false;
+        return addByte((_highNibble << 4) | v);
+    }
+    }
+}
+
+/**
+ * @brief Parse a sequence of characters.
+ * @param buf
+ * @param len
+ * @return the status after the first record or error found in buf, or
+ * HEX_INCOMPLETE if buf ends in the middle of a record.
+ *
+ * Characters following the first record or error are ignored.
+ */
+
+IntelHexParser::Status IntelHexParser::feed(const char *buf, const size_t len)
+{
+    for(size_t i = 0; i < len; i++) {
+        if(feed(buf[i]) != HEX_INCOMPLETE)
+            break;
+    }
+    return _status;
+}
+
+IntelHexParser::Status IntelHexParser::fail(const Status error, const char c)
+{
+    _state = isLineEnd(c) ? STATE_START : STATE_SKIP_LINE;
+    return _status = error;
+}
+
+IntelHexParser::Status IntelHexParser::addByte(const uint8_t b)
+{
+    _sum += b;
+    switch(_index) {
+    case 0:
+        if(b > MAX1464_HEX_MAX_DATA)
+            return fail(HEX_ERR_LENGTH, 0);
+        _byteCount = b;
+        break;
+    case 1:
+        _address = b << 8;
+        break;
+    case 2:
+        _address |= b;
+        break;
+    case 3:
+        _recordType = b;
+        break;
+    default:
+        if(_index < HEADER_SIZE + _byteCount) {
+            _data[_index - HEADER_SIZE] = b;
+            break;
+        }
+        // checksum
+        _state = STATE_START;
+        if(_sum != 0)
+            return _status = HEX_ERR_CHECKSUM;
+        if(_recordType != RECORD_DATA && _recordType != RECORD_EOF)
+            return _status = HEX_ERR_RECORD_TYPE;
+        return _status = HEX_RECORD_READY;
+    }
+    _index++;
+    return _status = HEX_INCOMPLETE;
+}
@@ -0,0 +1,115 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef INTELHEXPARSER_H
+#define INTELHEXPARSER_H
+
+#include <Arduino.h>
+
+#ifndef MAX1464_HEX_MAX_DATA
+/**
+ * @brief Largest data field accepted in a single HEX record, in bytes.
+ *
+ * The format allows up to 255 bytes per record, but each parser keeps a
+ * record in RAM. Longer records fail with HEX_ERR_LENGTH; the usual HEX files
+ * have 16 or 32 bytes per record. Define it up to 255 to accept any record.
+ */
+#define MAX1464_HEX_MAX_DATA 32
+#endif
+
+#if MAX1464_HEX_MAX_DATA > 255
+#error "MAX1464_HEX_MAX_DATA must not be larger than 255"
+#endif
+
+/**
+ * @brief Streaming parser for Intel HEX records.
+ *
+ * Characters are fed one at a time with feed(), so that a record can be
+ * parsed while it is being received, without buffering the text line and
+ * without any heap allocation. Whitespace and line terminators between
+ * records are ignored. After an error, the rest of the line is skipped.
+ */
+
+class IntelHexParser
+{
+public:
+    /**
+     * @brief Result of feeding a character to the parser.
+     */
+    enum Status {
+        HEX_INCOMPLETE,         ///< more characters are needed
+        HEX_RECORD_READY,       ///< a valid record has been parsed
+        HEX_ERR_START_CODE,     ///< a record does not start with ':'
+        HEX_ERR_DIGIT,          ///< illegal hexadecimal digit
+        HEX_ERR_LENGTH,         ///< data field longer than MAX1464_HEX_MAX_DATA
+        HEX_ERR_TRUNCATED,      ///< the line ended before the record did
+        HEX_ERR_CHECKSUM,       ///< wrong checksum
+        HEX_ERR_RECORD_TYPE,    ///< record type other than data or EOF
+    };
+
+    /**
+     * @brief Supported record types.
+     */
+    enum RecordType {
+        RECORD_DATA = 0x00,
+        RECORD_EOF  = 0x01,
+    };
+
+    IntelHexParser();
+    void reset();
+    Status feed(const char c);
+    Status feed(const char *buf, const size_t len);
+
+    /**
+     * @brief Status returned by the last call to feed().
+     */
+    Status status() const { return _status; }
+
+    // record fields, valid after HEX_RECORD_READY
+    uint8_t byteCount() const { return _byteCount; }
+    uint16_t address() const { return _address; }
+    uint8_t recordType() const { return _recordType; }
+    const uint8_t *data() const { return _data; }
+
+private:
+    enum State {
+        STATE_START,
+        STATE_FIELDS,
+        STATE_SKIP_LINE,
+    };
+
+    Status fail(const Status error, const char c);
+    Status addByte(const uint8_t b);
+
+    uint8_t _state;
+    Status _status;
+    uint16_t _index;        // index of the current byte within the record
+    uint8_t _highNibble;
+    boolean _haveHighNibble;
+    uint8_t _sum;
+    uint8_t _byteCount;
+    uint16_t _address;
+    uint8_t _recordType;
+    uint8_t _data[MAX1464_HEX_MAX_DATA];
+};
+
+#endif // INTELHEXPARSER_H
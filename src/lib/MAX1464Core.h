@@ -0,0 +1,1048 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464CORE_H
+#define MAX1464CORE_H
+
+#include <Arduino.h>
+#include "MAX1464_enums.h"
+#include "IntelHexParser.h"
+#include "printhex.h"
+
+//#define MAX1464_SERIALDEBUG
+//#define MAX1464_TRACE
+//#define MAX1464_STATS
+
+#ifdef MAX1464_TRACE
+#include "MAX1464Trace.h"
+#endif
+
+#ifdef MAX1464_STATS
+#include "MAX1464Stats.h"
+#endif
+
+/**
+ * @brief Size of the flash partitions, in bytes.
+ */
+#define MAX1464_PARTITION_0_SIZE 0x1000
+#define MAX1464_PARTITION_1_SIZE 0x80
+
+/**
+ * @brief Size of a flash page, in bytes.
+ *
+ * Partition 1 is made of a single page.
+ */
+#define MAX1464_FLASH_PAGE_SIZE 128
+
+/**
+ * @brief Time needed to program a flash byte, in microseconds.
+ */
+#define MAX1464_FLASH_WRITE_TIME_US 100
+
+/**
+ * @brief Time needed to erase a flash partition or page, in milliseconds.
+ */
+#define MAX1464_FLASH_ERASE_TIME_MS 5
+
+#ifndef MAX1464_BATCH_SIZE
+/**
+ * @brief Number of bytes queued by a batch before it is flushed.
+ */
+#define MAX1464_BATCH_SIZE 16
+#endif
+
+#if defined(MAX1464_SERIALDEBUG) || defined(MAX1464_TRACE)
+extern const char *cr_commands_debug_msgs[16];
+extern const char *irsa_debug_msgs[];
+#endif
+
+/**
+ * @brief Driver logic for the Maxim %MAX1464, parameterized on the bus.
+ *
+ * The Bus class carries out the serial communication. It must provide:
+ * \code
+ * Bus(const int chipSelect);
+ * void begin();
+ * void end();
+ * void byteShiftOut(const uint8_t b) const;  // one byte, framed by CS
+ * void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+ * uint16_t wordShiftIn() const;
+ * \endcode
+ *
+ * Bus functions are called statically, so that they can be inlined when they
+ * are not virtual. AbstractMAX1464 instantiates the core on a bus with
+ * virtual functions, which is what the MAX1464 and MAX1464_SS classes and the
+ * flashing helpers (FlashProgrammer, IncrementalFlashWriter, FlashVerifier)
+ * are built on. When the transport is known at compile time, a core
+ * instantiated on a concrete bus, e.g. MAX1464_Inline or MAX1464_SS_Inline,
+ * avoids an indirect call per byte.
+ */
+
+template <class Bus>
+class MAX1464Core : public Bus
+{
+public:
+    MAX1464Core(const int chipSelect = 10);
+
+    // simple CR functions
+    void haltCpu() const;
+    void resetCpu() const;
+    void releaseCpu() const;
+    void eraseFlashMemory() const;
+    void eraseFlashPartition(
+            const MAX1464_enums::FLASH_PARTITION partition) const;
+    void startErasingFlashPartition(
+            const MAX1464_enums::FLASH_PARTITION partition) const;
+    void eraseFlashPage(const MAX1464_enums::FLASH_PARTITION partition,
+                        const uint16_t addr) const;
+    void startErasingFlashPage(const MAX1464_enums::FLASH_PARTITION partition,
+                               const uint16_t addr) const;
+    void copyFlashToDhr() const;
+    void singleStepCpu() const;
+
+    // IRSA functions
+    void setFlashAddress(const uint16_t addr) const;
+    void writeDHR(const uint16_t data) const;
+    void writeDHRLSB(const uint8_t data) const;
+    void writeCR(const MAX1464_enums::CR_COMMAND cmd) const;
+    void writeNibble(
+            const uint8_t nibble, const MAX1464_enums::IRSA irsa) const;
+    void invalidateRegisterCache() const;
+
+    // batching
+    void beginBatch() const;
+    void flushBatch() const;
+    void endBatch() const;
+
+    // Flash memory
+    void prepareForFlashing() const;
+    void beginWritingToFlashPartition(const MAX1464_enums::FLASH_PARTITION partition) const;
+    boolean writeHexLineToFlashMemory(const String &hexline);
+    boolean writeHexLineToFlashMemory(const char *hexline, const size_t len);
+    boolean writeHexRecordToFlashMemory(const IntelHexParser &record);
+    IntelHexParser::Status hexLineStatus() const;
+    void readFlashPartition(
+            const MAX1464_enums::FLASH_PARTITION partition
+            = MAX1464_enums::PARTITION_0, Print &out = Serial) const;
+    void readFlash(const MAX1464_enums::FLASH_PARTITION partition,
+                   const uint16_t addr, const uint16_t len,
+                   uint8_t *out) const;
+    void writeByteToFlash(const uint8_t value, const uint16_t addr) const;
+    boolean startWritingByteToFlash(
+            const uint8_t value, const uint16_t addr) const;
+    void setSkipErasedBytes(const boolean enable);
+    unsigned long skippedFlashWrites() const;
+    boolean hasEOFBeenReached() const;
+
+    // CPU ports
+    uint16_t readCpuPort(const MAX1464_enums::CPU_PORT port) const;
+    void writeCpuPort(
+            const uint16_t word, const MAX1464_enums::CPU_PORT port) const;
+
+    // module registers
+    void writeModuleRegister(const uint16_t data,
+                             const MAX1464_enums::MODULE_REGISTER_ADDRESS addr
+                             ) const;
+    uint16_t readModuleRegister(
+            const MAX1464_enums::MODULE_REGISTER_ADDRESS addr) const;
+    void setModulePortCache(const boolean enable);
+
+    // CPU registers
+    uint16_t readCpuAccumulatorRegister() const;
+    uint16_t readCpuProgramCounter() const;
+
+#ifdef MAX1464_STATS
+    // performance counters
+    const MAX1464Stats &stats() const { return _stats; }
+    void clearStats() { _stats.clear(); }
+#endif
+
+private:
+    void waitMillis(const unsigned long ms) const;
+    void waitMicros(const unsigned int us) const;
+    uint16_t readWord() const;
+    void selectFlashPartition(
+            const MAX1464_enums::FLASH_PARTITION partition) const;
+    void readFlashData(const uint16_t addr, const uint16_t len,
+                       uint8_t *out) const;
+    boolean modulePortWriteNeeded(
+            const uint16_t word, const MAX1464_enums::CPU_PORT port) const;
+
+    boolean EOFReached;
+    IntelHexParser::Status _hexStatus;
+    mutable uint8_t _batch[MAX1464_BATCH_SIZE];
+    mutable uint8_t _batchLength;
+    mutable uint8_t _batchDepth;
+    mutable uint8_t _irsaShadow[8];
+    mutable uint8_t _irsaShadowValid;
+    boolean _skipErasedBytes;
+    mutable boolean _flashErased;
+    mutable unsigned long _skippedFlashWrites;
+    boolean _modulePortCache;
+    mutable boolean _cpuHalted;
+    mutable uint8_t _modulePortValid;  // bit 0: data port, 1: address port
+    mutable uint16_t _modulePorts[2];
+#ifdef MAX1464_STATS
+    mutable MAX1464Stats _stats;
+#endif
+};
+
+
+
+
+template <class Bus>
+MAX1464Core<Bus>::MAX1464Core(const int chipSelect) :
+    Bus(chipSelect)
+{
+    EOFReached = false;
+    _hexStatus = IntelHexParser::HEX_INCOMPLETE;
+    _batchLength = 0;
+    _batchDepth = 0;
+    _skipErasedBytes = false;
+    _skippedFlashWrites = 0;
+    _modulePortCache = false;
+    _cpuHalted = false;
+    invalidateRegisterCache();
+#ifdef MAX1464_STATS
+    _stats.clear();
+#endif
+}
+
+
+
+// simple CR functions
+
+template <class Bus>
+void MAX1464Core<Bus>::haltCpu() const
+{
+    writeCR(MAX1464_enums::CR_HALT_CPU);
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::resetCpu() const
+{
+    beginBatch();
+    haltCpu();
+    writeCR(MAX1464_enums::CR_RESET_PC);
+    releaseCpu();
+    endBatch();
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::releaseCpu() const
+{
+    writeCR(MAX1464_enums::CR_START_CPU);
+}
+
+/**
+ * @brief Erase flash memory, both partitions.
+ *
+ * \pre CPU must be halted.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::eraseFlashMemory() const
+{
+    eraseFlashPartition(MAX1464_enums::PARTITION_0);
+    eraseFlashPartition(MAX1464_enums::PARTITION_1);
+}
+
+/**
+ * @brief Erase a flash partition.
+ * @param partition
+ *
+ * \pre CPU must be halted.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::eraseFlashPartition(
+        const MAX1464_enums::FLASH_PARTITION partition) const
+{
+#ifdef MAX1464_STATS
+    MAX1464StatsScope scope(_stats, MAX1464Stats::ERASE_FLASH_PARTITION);
+#endif
+    startErasingFlashPartition(partition);
+    flushBatch();
+    waitMillis(MAX1464_FLASH_ERASE_TIME_MS);
+}
+
+/**
+ * @brief Issue the erase command for a flash partition and return
+ * immediately.
+ * @param partition
+ *
+ * The caller must wait MAX1464_FLASH_ERASE_TIME_MS before accessing the
+ * flash memory again.
+ *
+ * \pre CPU must be halted.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::startErasingFlashPartition(
+        const MAX1464_enums::FLASH_PARTITION partition) const
+{
+    beginBatch();
+    if(partition == MAX1464_enums::PARTITION_1)
+        writeCR(MAX1464_enums::CR_SELECT_FLASH_PARTITION_1);
+    else
+        haltCpu();
+    writeCR(MAX1464_enums::CR_ERASE_FLASH_PARTITION);
+    endBatch();
+    _flashErased = true;
+}
+
+/**
+ * @brief Erase the flash page containing addr.
+ * @param partition
+ * @param addr any address within the page
+ *
+ * \pre CPU must be halted.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::eraseFlashPage(
+        const MAX1464_enums::FLASH_PARTITION partition,
+        const uint16_t addr) const
+{
+    startErasingFlashPage(partition, addr);
+    flushBatch();
+    waitMillis(MAX1464_FLASH_ERASE_TIME_MS);
+}
+
+/**
+ * @brief Issue the erase command for a flash page and return immediately.
+ * @param partition
+ * @param addr any address within the page
+ *
+ * The caller must wait MAX1464_FLASH_ERASE_TIME_MS before accessing the
+ * flash memory again.
+ *
+ * \pre CPU must be halted.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::startErasingFlashPage(
+        const MAX1464_enums::FLASH_PARTITION partition,
+        const uint16_t addr) const
+{
+    beginBatch();
+    if(partition == MAX1464_enums::PARTITION_1)
+        writeCR(MAX1464_enums::CR_SELECT_FLASH_PARTITION_1);
+    else
+        haltCpu();
+    setFlashAddress(addr & ~(MAX1464_FLASH_PAGE_SIZE - 1));
+    writeCR(MAX1464_enums::CR_ERASE_FLASH_PAGE);
+    endBatch();
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::copyFlashToDhr() const
+{
+    writeCR(MAX1464_enums::CR_READ8_FLASH);
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::singleStepCpu() const
+{
+    writeCR(MAX1464_enums::CR_SINGLE_STEP_CPU);
+}
+
+
+
+//IRSA functions
+
+/**
+ * @brief Write flash address into PFAR[11:0]
+ * @param addr
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::setFlashAddress(const uint16_t addr) const
+{
+    beginBatch();
+    writeNibble(0, MAX1464_enums::IRSA_PFAR3);
+    writeNibble((addr >> (4*2)) & 0xf, MAX1464_enums::IRSA_PFAR2);
+    writeNibble((addr >> (4*1)) & 0xf, MAX1464_enums::IRSA_PFAR1);
+    writeNibble((addr >> (4*0)) & 0xf, MAX1464_enums::IRSA_PFAR0);
+    endBatch();
+}
+
+/**
+ * @brief Write data to DHR[15:0]
+ * @param data
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::writeDHR(const uint16_t data) const
+{
+    beginBatch();
+    writeNibble((data >> (4*3)) & 0xf, MAX1464_enums::IRSA_DHR3);
+    writeNibble((data >> (4*2)) & 0xf, MAX1464_enums::IRSA_DHR2);
+    writeNibble((data >> (4*1)) & 0xf, MAX1464_enums::IRSA_DHR1);
+    writeNibble((data >> (4*0)) & 0xf, MAX1464_enums::IRSA_DHR0);
+    endBatch();
+}
+
+/**
+ * @brief Write data to DHR[8:0]
+ * @param data
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::writeDHRLSB(const uint8_t data) const
+{
+    writeNibble((data >> (4*1)) & 0xf, MAX1464_enums::IRSA_DHR1);
+    writeNibble((data >> (4*0)) & 0xf, MAX1464_enums::IRSA_DHR0);
+}
+
+/**
+ * @brief Write command to CR[3:0]
+ * @param cmd
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::writeCR(const MAX1464_enums::CR_COMMAND cmd) const
+{
+    writeNibble(cmd, MAX1464_enums::IRSA_CR);
+}
+
+/**
+ * @brief Write a nibble to the destination specified by irsa
+ * @param nibble
+ * @param irsa
+ *
+ * A shadow copy of the DHR and PFAR nibbles is kept, and writes that would
+ * not change them are skipped. Commands that load the DHR invalidate its
+ * shadow copy.
+ *
+ * \sa invalidateRegisterCache()
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::writeNibble(
+        const uint8_t nibble, const MAX1464_enums::IRSA irsa) const
+{
+    if(irsa <= MAX1464_enums::IRSA_PFAR3) {
+        const uint8_t mask = 1 << irsa;
+        if((_irsaShadowValid & mask) && _irsaShadow[irsa] == nibble)
+            return;
+        _irsaShadow[irsa] = nibble;
+        _irsaShadowValid |= mask;
+    }
+    else if(irsa == MAX1464_enums::IRSA_CR) {
+        switch(nibble) {
+        case MAX1464_enums::CR_READ16_CPU_PORT:
+        case MAX1464_enums::CR_READ8_FLASH:
+        case MAX1464_enums::CR_READ16_CPU_ACC:
+        case MAX1464_enums::CR_READ8_FLASH_PC:
+        case MAX1464_enums::CR_READ16_CPU_PC:
+            _irsaShadowValid &= 0xf0;  // DHR is overwritten
+            break;
+        case MAX1464_enums::CR_HALT_CPU:
+            _cpuHalted = true;
+            break;
+        case MAX1464_enums::CR_START_CPU:
+            // the firmware may change the ports from now on
+            _cpuHalted = false;
+            _modulePortValid = 0;
+            break;
+        case MAX1464_enums::CR_SINGLE_STEP_CPU:
+            _modulePortValid = 0;
+            break;
+        default:
+            break;
+        }
+    }
+
+#ifdef MAX1464_SERIALDEBUG
+    Serial.print("write nibble 0x");
+    Serial.print(nibble, HEX);
+    Serial.print("and destination address ");
+    Serial.println(irsa_debug_msgs[irsa]);
+    if(irsa == MAX1464_enums::IRSA_CR) {
+        Serial.println(cr_commands_debug_msgs[nibble]);
+    }
+#endif
+    const uint8_t b = (nibble << 4) | (irsa & 0xf);
+    if(_batchDepth == 0) {
+#ifdef MAX1464_STATS
+        _stats.bytesOut++;
+        _stats.transactions++;
+#endif
+#ifdef MAX1464_TRACE
+        MAX1464Trace::recordWrite(b);
+#endif
+        this->byteShiftOut(b);
+        return;
+    }
+    if(_batchLength == MAX1464_BATCH_SIZE)
+        flushBatch();
+    _batch[_batchLength++] = b;
+}
+
+
+
+// batching
+
+/**
+ * @brief Start queueing nibble writes.
+ *
+ * From now on, writeNibble() appends to an internal queue instead of
+ * shifting out each byte on its own. The queue is sent in a single burst with
+ * bufferShiftOut() when it is full, before any read, before the flash
+ * programming and erase delays, and when the outermost endBatch() is called.
+ * Calls can be nested.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::beginBatch() const
+{
+    _batchDepth++;
+}
+
+/**
+ * @brief Send the queued bytes, if any.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::flushBatch() const
+{
+    if(_batchLength == 0)
+        return;
+#ifdef MAX1464_STATS
+    _stats.bytesOut += _batchLength;
+    _stats.transactions++;
+#endif
+#ifdef MAX1464_TRACE
+    for(uint8_t i = 0; i < _batchLength; i++)
+        MAX1464Trace::recordWrite(_batch[i]);
+#endif
+    this->bufferShiftOut(_batch, _batchLength);
+    _batchLength = 0;
+}
+
+/**
+ * @brief Close a batch opened with beginBatch().
+ *
+ * The queue is flushed when the outermost batch is closed.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::endBatch() const
+{
+    if(_batchDepth == 0)
+        return;
+    if(--_batchDepth == 0)
+        flushBatch();
+}
+
+template <class Bus>
+uint16_t MAX1464Core<Bus>::readWord() const
+{
+    flushBatch();
+    // the bits clocked in while reading may end up in the DHR
+    _irsaShadowValid &= 0xf0;
+#ifdef MAX1464_STATS
+    _stats.wordsIn++;
+    _stats.transactions++;
+#endif
+#ifdef MAX1464_TRACE
+    const uint16_t w = this->wordShiftIn();
+    MAX1464Trace::recordRead(w);
+    return w;
+#else
+    return this->wordShiftIn();
+#endif
+}
+
+/**
+ * @brief delay(), counted in MAX1464Stats::delayMicros.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::waitMillis(const unsigned long ms) const
+{
+#ifdef MAX1464_STATS
+    _stats.delayMicros += ms * 1000;
+#endif
+    delay(ms);
+}
+
+/**
+ * @brief delayMicroseconds(), counted in MAX1464Stats::delayMicros.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::waitMicros(const unsigned int us) const
+{
+#ifdef MAX1464_STATS
+    _stats.delayMicros += us;
+#endif
+    delayMicroseconds(us);
+}
+
+/**
+ * @brief Forget the shadow copy of the DHR and PFAR registers.
+ *
+ * The next writes to these registers, and to the module ports (see
+ * setModulePortCache()), will be sent to the device unconditionally, and
+ * flash partitions are no longer assumed to be erased.
+ * Call this function whenever the device state may have changed without the
+ * library knowing, e.g. after a power cycle, after swapping the chip, or after
+ * sending bytes directly with byteShiftOut().
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::invalidateRegisterCache() const
+{
+    _irsaShadowValid = 0;
+    _flashErased = false;
+    _modulePortValid = 0;
+}
+
+
+
+// Flash memory
+
+/**
+ * @brief Prepare to write flash memory
+ * @param partition
+ *
+ *
+ * This function halts the CPU, disables all analog modules and erases the
+ * selected partition. To actually flash the firmware, call
+ * writeHexLineToFlashMemory() for every hex line to be written.
+ *
+ * \warning The selected partition will be erased.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::beginWritingToFlashPartition(
+        const MAX1464_enums::FLASH_PARTITION partition) const
+{
+    prepareForFlashing();
+    eraseFlashPartition(partition);
+}
+
+/**
+ * @brief Halt the CPU and disable all analog modules before writing to flash
+ * memory.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::prepareForFlashing() const
+{
+// see datasheet, page 21
+    beginBatch();
+    haltCpu();
+    writeModuleRegister(MAX1464_enums::PWR_ALL_OFF,
+                        MAX1464_enums::R_PO_CONTROL);
+    endBatch();
+}
+
+/**
+ * @brief Flashes a single Intel HEX line
+ * @param hexline string containing a single line from a hex file
+ * @return false if the provided line is illegal, true otherwise
+ *
+ *
+ * \pre beginWritingToFlashPartition() must have been called at the beginning of a
+ * flash cycle.
+ *
+ * \sa hexLineStatus()
+ */
+
+template <class Bus>
+boolean MAX1464Core<Bus>::writeHexLineToFlashMemory(const String &hexline)
+{
+    return writeHexLineToFlashMemory(hexline.c_str(), hexline.length());
+}
+
+/**
+ * @brief Flashes a single Intel HEX line
+ * @param hexline characters of a single line from a hex file (not necessarily
+ * NUL-terminated)
+ * @param len number of characters in hexline
+ * @return false if the provided line is illegal, true otherwise
+ *
+ * Characters following the first record are ignored.
+ *
+ * \pre beginWritingToFlashPartition() must have been called at the beginning of a
+ * flash cycle.
+ *
+ * \sa hexLineStatus()
+ */
+
+template <class Bus>
+boolean MAX1464Core<Bus>::writeHexLineToFlashMemory(
+        const char *hexline, const size_t len)
+{
+    IntelHexParser parser;
+    _hexStatus = parser.feed(hexline, len);
+    if(_hexStatus == IntelHexParser::HEX_INCOMPLETE)
+        _hexStatus = IntelHexParser::HEX_ERR_TRUNCATED;
+    if(_hexStatus != IntelHexParser::HEX_RECORD_READY)
+        return false;
+    return writeHexRecordToFlashMemory(parser);
+}
+
+/**
+ * @brief Flashes a record parsed by an IntelHexParser
+ * @param record a parser whose last status is HEX_RECORD_READY
+ * @return false if the parser does not hold a valid record, true otherwise
+ *
+ * This allows to parse HEX files while they are being received, one
+ * character at a time, without storing whole lines:
+ * \code
+ * IntelHexParser parser;
+ * ...
+ * if(parser.feed(Serial.read()) == IntelHexParser::HEX_RECORD_READY)
+ *     max1464.writeHexRecordToFlashMemory(parser);
+ * \endcode
+ *
+ * \pre beginWritingToFlashPartition() must have been called at the beginning of a
+ * flash cycle.
+ */
+
+template <class Bus>
+boolean MAX1464Core<Bus>::writeHexRecordToFlashMemory(
+        const IntelHexParser &record)
+{
+    _hexStatus = record.status();
+    if(_hexStatus != IntelHexParser::HEX_RECORD_READY)
+        return false;
+    if(record.recordType() == IntelHexParser::RECORD_EOF) {
+        EOFReached = true;
+        return true;
+    }
+    else
+        EOFReached = false;
+    uint16_t addr = record.address();
+    const uint8_t *data = record.data();
+    for (uint8_t count = 0; count < record.byteCount(); ++count)
+        writeByteToFlash(data[count],addr++);
+    return true;
+}
+
+/**
+ * @brief Read a flash partition
+ * @param partition
+ * @param out where to print the HEX records (Serial by default)
+ *
+ *
+ * This function halts the CPU then prints the whole content of the specified
+ * flash partition in Intel HEX format.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::readFlashPartition(
+        const MAX1464_enums::FLASH_PARTITION partition, Print &out) const {
+#ifdef MAX1464_STATS
+    MAX1464StatsScope scope(_stats, MAX1464Stats::READ_FLASH_PARTITION);
+#endif
+    uint8_t temp[16];
+    uint16_t partition_size = MAX1464_PARTITION_0_SIZE;
+    if(partition == MAX1464_enums::PARTITION_1)
+        partition_size = MAX1464_PARTITION_1_SIZE;
+    selectFlashPartition(partition);
+    for(uint16_t addr = 0; addr < partition_size; addr += 16) {
+        readFlashData(addr, 16, temp);
+        printHexRecord(out, addr, 0x00, temp, 16);
+    }
+    printHexRecord(out, 0, 0x01, NULL, 0);
+}
+
+/**
+ * @brief Read a block of flash memory
+ * @param partition
+ * @param addr address of the first byte
+ * @param len number of bytes to read
+ * @param out destination buffer, at least len bytes long
+ *
+ * This function halts the CPU, then reads the bytes back-to-back.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::readFlash(
+        const MAX1464_enums::FLASH_PARTITION partition, const uint16_t addr,
+        const uint16_t len, uint8_t *out) const
+{
+    selectFlashPartition(partition);
+    readFlashData(addr, len, out);
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::selectFlashPartition(
+        const MAX1464_enums::FLASH_PARTITION partition) const
+{
+    beginBatch();
+    haltCpu();
+    if(partition == MAX1464_enums::PARTITION_1)
+        writeCR(MAX1464_enums::CR_SELECT_FLASH_PARTITION_1);
+    endBatch();
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::readFlashData(
+        const uint16_t addr, const uint16_t len, uint8_t *out) const
+{
+    for(uint16_t i = 0; i < len; i++) {
+        beginBatch();
+        setFlashAddress(addr + i);
+        copyFlashToDhr();
+        endBatch();
+        out[i] = readWord() & 0xff;
+    }
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::writeByteToFlash(
+        const uint8_t value, const uint16_t addr) const
+{
+#ifdef MAX1464_STATS
+    MAX1464StatsScope scope(_stats, MAX1464Stats::WRITE_BYTE_TO_FLASH);
+#endif
+    if(!startWritingByteToFlash(value, addr))
+        return;
+    flushBatch();
+    waitMicros(MAX1464_FLASH_WRITE_TIME_US);
+}
+
+/**
+ * @brief Issue the commands to program a flash byte and return immediately.
+ * @param value
+ * @param addr
+ * @return false if the write was skipped (see setSkipErasedBytes())
+ *
+ * The caller must wait MAX1464_FLASH_WRITE_TIME_US before accessing the flash
+ * memory again.
+ */
+
+template <class Bus>
+boolean MAX1464Core<Bus>::startWritingByteToFlash(
+        const uint8_t value, const uint16_t addr) const
+{
+    if(_skipErasedBytes && _flashErased && value == 0xff) {
+        _skippedFlashWrites++;
+        return false;
+    }
+    beginBatch();
+    setFlashAddress(addr);
+    writeDHRLSB(value);
+    writeCR(MAX1464_enums::CR_WRITE8_DHR_TO_FLASH_MEMORY);
+    endBatch();
+    return true;
+}
+
+/**
+ * @brief Skip programming bytes that already hold the erased value.
+ * @param enable
+ *
+ * When enabled, writeByteToFlash() and startWritingByteToFlash() do not
+ * program 0xFF bytes, and do not wait for them, as long as a partition has
+ * been erased through this object (e.g. by beginWritingToFlashPartition())
+ * since the last invalidateRegisterCache(). Padded regions of HEX images are
+ * thus skipped entirely. Disabled by default.
+ *
+ * \sa skippedFlashWrites()
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::setSkipErasedBytes(const boolean enable)
+{
+    _skipErasedBytes = enable;
+}
+
+/**
+ * @brief Number of flash writes skipped since the object was created.
+ *
+ * \sa setSkipErasedBytes()
+ */
+
+template <class Bus>
+unsigned long MAX1464Core<Bus>::skippedFlashWrites() const
+{
+    return _skippedFlashWrites;
+}
+
+/**
+ * @brief Last line of the HEX file.
+ * @return true if writeHexLineToFlashMemory() was last called with the last
+ * line of a HEX file (0x01 record type), false otherwise.
+ */
+
+template <class Bus>
+boolean MAX1464Core<Bus>::hasEOFBeenReached() const {
+    return EOFReached;
+}
+
+/**
+ * @brief Outcome of the last HEX line or record written to flash.
+ * @return IntelHexParser::HEX_RECORD_READY if the record was valid, the
+ * error found otherwise.
+ */
+
+template <class Bus>
+IntelHexParser::Status MAX1464Core<Bus>::hexLineStatus() const {
+    return _hexStatus;
+}
+
+
+// CPU ports
+
+template <class Bus>
+uint16_t MAX1464Core<Bus>::readCpuPort(const MAX1464_enums::CPU_PORT port) const
+{
+#ifdef MAX1464_STATS
+    MAX1464StatsScope scope(_stats, MAX1464Stats::READ_CPU_PORT);
+#endif
+    beginBatch();
+    writeNibble(port, MAX1464_enums::IRSA_PFAR0);
+    writeCR(MAX1464_enums::CR_READ16_CPU_PORT);
+    endBatch();
+    return readWord();
+}
+
+template <class Bus>
+void MAX1464Core<Bus>::writeCpuPort(
+        const uint16_t word, const MAX1464_enums::CPU_PORT port) const
+{
+    if(!modulePortWriteNeeded(word, port))
+        return;
+    beginBatch();
+    writeDHR(word);
+    writeNibble(port, MAX1464_enums::IRSA_PFAR0);
+    writeCR(MAX1464_enums::CR_WRITE16_DHR_TO_CPU_PORT);
+    endBatch();
+}
+
+
+
+// module registers
+
+template <class Bus>
+void MAX1464Core<Bus>::writeModuleRegister(
+        const uint16_t data,
+        const MAX1464_enums::MODULE_REGISTER_ADDRESS addr) const
+{
+    beginBatch();
+    writeCpuPort(data, MAX1464_enums::MODULE_DATA_PORT);
+    writeCpuPort(addr, MAX1464_enums::MODULE_ADDRESS_PORT);
+    uint16_t control = (1 << 15);
+    writeCpuPort(control, MAX1464_enums::MODULE_CONTROL_PORT);
+    endBatch();
+}
+
+template <class Bus>
+uint16_t MAX1464Core<Bus>::readModuleRegister(
+        const MAX1464_enums::MODULE_REGISTER_ADDRESS addr) const
+{
+#ifdef MAX1464_STATS
+    MAX1464StatsScope scope(_stats, MAX1464Stats::READ_MODULE_REGISTER);
+#endif
+    beginBatch();
+    writeCpuPort(addr, MAX1464_enums::MODULE_ADDRESS_PORT);
+    uint16_t control = (1 << 15);
+    control |= (1 << 14); // read
+    writeCpuPort(control, MAX1464_enums::MODULE_CONTROL_PORT);
+    uint16_t data = readCpuPort(MAX1464_enums::MODULE_DATA_PORT);
+    endBatch();
+    if(_modulePortCache && _cpuHalted) {
+        _modulePorts[0] = data;
+        _modulePortValid |= 1;
+    }
+    return data;
+}
+
+/**
+ * @brief Remember what was written to the module address and data ports.
+ * @param enable
+ *
+ * When enabled, writes that would not change MODULE_ADDRESS_PORT or
+ * MODULE_DATA_PORT are skipped, so that repeated accesses to the same module
+ * register only send the control word, which starts the access. The cache is
+ * only used while the CPU is halted through this object, as the firmware may
+ * change the ports: it is emptied by every CR command that starts or
+ * single-steps the CPU, whether sent by releaseCpu(), resetCpu(),
+ * singleStepCpu() or writeCR(), and by invalidateRegisterCache(). It is not
+ * filled again until the next CR_HALT_CPU. Disabled by default.
+ */
+
+template <class Bus>
+void MAX1464Core<Bus>::setModulePortCache(const boolean enable)
+{
+    _modulePortCache = enable;
+    _modulePortValid = 0;
+}
+
+/**
+ * @brief Check a port write against the module port cache, and update it.
+ * @return false if the write can be skipped
+ */
+
+template <class Bus>
+boolean MAX1464Core<Bus>::modulePortWriteNeeded(
+        const uint16_t word, const MAX1464_enums::CPU_PORT port) const
+{
+    if(!_modulePortCache || !_cpuHalted)
+        return true;
+    uint8_t i;
+    switch(port) {
+    case MAX1464_enums::MODULE_DATA_PORT:
+        i = 0;
+        break;
+    case MAX1464_enums::MODULE_ADDRESS_PORT:
+        i = 1;
+        break;
+    case MAX1464_enums::MODULE_CONTROL_PORT:
+        if(word & (1 << 14))  // a read access loads the data port
+            _modulePortValid &= ~1;
+        return true;
+    default:
+        return true;
+    }
+    if((_modulePortValid & (1 << i)) && _modulePorts[i] == word)
+        return false;
+    _modulePorts[i] = word;
+    _modulePortValid |= 1 << i;
+    return true;
+}
+
+
+
+// CPU registers
+
+template <class Bus>
+uint16_t MAX1464Core<Bus>::readCpuAccumulatorRegister() const
+{
+    writeCR(MAX1464_enums::CR_READ16_CPU_ACC);
+    return readWord();
+}
+
+template <class Bus>
+uint16_t MAX1464Core<Bus>::readCpuProgramCounter() const
+{
+    writeCR(MAX1464_enums::CR_READ16_CPU_PC);
+    return readWord();
+}
+
+#endif // MAX1464CORE_H
@@ -0,0 +1,121 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464FASTPIN_H
+#define MAX1464FASTPIN_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Digital pin selected at compile time.
+ *
+ * On the ATmega328P and ATmega168 (Arduino Uno, Nano, Pro Mini) the port
+ * register and bit mask are computed at compile time, so that high() and
+ * low() compile to a single sbi/cbi instruction. On other AVR boards they are
+ * looked up once by init() and cached. Elsewhere digitalWrite() and
+ * digitalRead() are used.
+ */
+
+template <uint8_t pin>
+class MAX1464FastPin
+{
+public:
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+    static_assert(pin < 20, "MAX1464FastPin: no such pin on this board");
+
+    static inline void init() {}
+    static inline void high() { out() |= mask; }
+    static inline void low() { out() &= ~mask; }
+    static inline void write(const uint8_t level) {
+        if(level)
+            high();
+        else
+            low();
+    }
+    static inline uint8_t read() { return (in() & mask) ? HIGH : LOW; }
+    static inline void output() { ddr() |= mask; }
+    static inline void input() { ddr() &= ~mask; }
+
+private:
+    static const uint8_t mask = 1 << (pin < 8 ? pin : pin < 14 ? pin - 8
+                                                               : pin - 14);
+    static inline volatile uint8_t &out() {
+        return pin < 8 ? PORTD : pin < 14 ? PORTB : PORTC;
+    }
+    static inline volatile uint8_t &in() {
+        return pin < 8 ? PIND : pin < 14 ? PINB : PINC;
+    }
+    static inline volatile uint8_t &ddr() {
+        return pin < 8 ? DDRD : pin < 14 ? DDRB : DDRC;
+    }
+
+#elif defined(ARDUINO_ARCH_AVR)
+    static inline void init() {
+        const uint8_t port = digitalPinToPort(pin);
+        _out = portOutputRegister(port);
+        _in = portInputRegister(port);
+        _ddr = portModeRegister(port);
+        _mask = digitalPinToBitMask(pin);
+    }
+    static inline void high() { update(_out, true); }
+    static inline void low() { update(_out, false); }
+    static inline void write(const uint8_t level) { update(_out, level); }
+    static inline uint8_t read() { return (*_in & _mask) ? HIGH : LOW; }
+    static inline void output() { update(_ddr, true); }
+    static inline void input() { update(_ddr, false); }
+
+private:
+    static inline void update(volatile uint8_t *reg, const boolean set) {
+        const uint8_t oldSREG = SREG;
+        cli();
+        if(set)
+            *reg |= _mask;
+        else
+            *reg &= ~_mask;
+        SREG = oldSREG;
+    }
+
+    static volatile uint8_t *_out, *_in, *_ddr;
+    static uint8_t _mask;
+
+#else
+    static inline void init() {}
+    static inline void high() { digitalWrite(pin, HIGH); }
+    static inline void low() { digitalWrite(pin, LOW); }
+    static inline void write(const uint8_t level) {
+        digitalWrite(pin, level ? HIGH : LOW);
+    }
+    static inline uint8_t read() { return digitalRead(pin); }
+    static inline void output() { pinMode(pin, OUTPUT); }
+    static inline void input() { pinMode(pin, INPUT); }
+#endif
+};
+
+#if !(defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)) \
+    && defined(ARDUINO_ARCH_AVR)
+template <uint8_t pin> volatile uint8_t *MAX1464FastPin<pin>::_out;
+template <uint8_t pin> volatile uint8_t *MAX1464FastPin<pin>::_in;
+template <uint8_t pin> volatile uint8_t *MAX1464FastPin<pin>::_ddr;
+template <uint8_t pin> uint8_t MAX1464FastPin<pin>::_mask;
+#endif
+
+#endif // MAX1464FASTPIN_H
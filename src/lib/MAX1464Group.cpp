@@ -0,0 +1,197 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "MAX1464Group.h"
+
+/**
+ * @brief Constructor.
+ * @param bus driver carrying out the transfers, e.g. a MAX1464 or MAX1464_SS
+ * @param chipSelect chip select of the first device
+ */
+
+MAX1464Group::MAX1464Group(AbstractMAX1464 &bus, const int chipSelect) :
+    AbstractMAX1464(chipSelect), _bus(bus)
+{
+    pinMode(chipSelect, OUTPUT);
+    digitalWrite(chipSelect, HIGH);
+    _chipSelects[0] = chipSelect;
+    _count = 1;
+    _selected = 1;
+    _first = 0;
+    _readDevice = 0;
+    _busChipSelect = _bus.chipSelect();
+}
+
+/**
+ * @brief Initialize the bus and every device in the group.
+ *
+ * The register caches of both the group and the bus are invalidated.
+ */
+
+void MAX1464Group::begin()
+{
+    _busChipSelect = _bus.chipSelect();
+    for(uint8_t i = 0; i < _count; i++) {
+        _bus.setChipSelect(_chipSelects[i]);
+        _bus.begin();
+    }
+    _bus.setChipSelect(_chipSelects[_first]);
+    _bus.invalidateRegisterCache();
+    invalidateRegisterCache();
+}
+
+/**
+ * @brief Release the bus, restoring the chip select it had at begin().
+ */
+
+void MAX1464Group::end()
+{
+    flushBatch();
+    _bus.end();
+    _bus.setChipSelect(_busChipSelect);
+    _bus.invalidateRegisterCache();
+}
+
+/**
+ * @brief Add a device to the group.
+ * @param chipSelect
+ * @return the index of the device, or -1 if the group is full
+ *
+ * The new device is selected.
+ */
+
+int8_t MAX1464Group::addDevice(const int chipSelect)
+{
+    if(_count == MAX1464_GROUP_SIZE)
+        return -1;
+    pinMode(chipSelect, OUTPUT);
+    digitalWrite(chipSelect, HIGH);
+    _chipSelects[_count] = chipSelect;
+    _count++;
+    selectDevices(_selected | (1 << (_count - 1)));
+    return _count - 1;
+}
+
+/**
+ * @brief Choose the devices that receive the writes.
+ * @param mask bit i selects device i
+ * @return false, leaving the selection unchanged, if mask selects none of the
+ * devices in the group
+ *
+ * Bits beyond deviceCount() are ignored. The register cache is invalidated,
+ * as the devices may not hold the same values.
+ */
+
+boolean MAX1464Group::selectDevices(const uint8_t mask)
+{
+    const uint8_t selected = mask & ((1u << _count) - 1);
+    if(selected == 0)
+        return false;
+    flushBatch();
+    _selected = selected;
+    _first = 0;
+    while(!(_selected & (1 << _first)))
+        _first++;
+    _bus.setChipSelect(_chipSelects[_first]);
+    _bus.invalidateRegisterCache();
+    invalidateRegisterCache();
+    return true;
+}
+
+/**
+ * @brief Select all the devices in the group.
+ */
+
+void MAX1464Group::selectAll()
+{
+    selectDevices((1 << _count) - 1);
+}
+
+/**
+ * @brief Choose the device that is read from.
+ * @param index
+ *
+ * The commands preceding a read are sent to all the selected devices, so the
+ * read device should be one of them.
+ */
+
+void MAX1464Group::setReadDevice(const uint8_t index)
+{
+    if(index < _count)
+        _readDevice = index;
+}
+
+void MAX1464Group::byteShiftOut(const uint8_t b, const char *debugMsg) const
+{
+    setOthers(LOW);
+    _bus.byteShiftOut(b, debugMsg);
+    setOthers(HIGH);
+    _bus.invalidateRegisterCache();
+}
+
+/**
+ * @brief Shift out a sequence of bytes.
+ * @param buf
+ * @param len
+ *
+ * With a single device selected the whole sequence is handed to the bus;
+ * otherwise the other chip select lines are pulsed along with every byte.
+ */
+
+void MAX1464Group::bufferShiftOut(const uint8_t *buf, const uint8_t len) const
+{
+    if((_selected & (_selected - 1)) == 0) {
+        _bus.bufferShiftOut(buf, len);
+        _bus.invalidateRegisterCache();
+        return;
+    }
+    for(uint8_t i = 0; i < len; i++)
+        byteShiftOut(buf[i]);
+}
+
+uint16_t MAX1464Group::wordShiftIn() const
+{
+    uint16_t w;
+    if(_readDevice == _first) {
+        w = _bus.wordShiftIn();
+    }
+    else {
+        _bus.setChipSelect(_chipSelects[_readDevice]);
+        w = _bus.wordShiftIn();
+        _bus.setChipSelect(_chipSelects[_first]);
+    }
+    _bus.invalidateRegisterCache();
+    return w;
+}
+
+/**
+ * @brief Drive the chip select of the selected devices other than the one
+ * driven by the bus.
+ */
+
+void MAX1464Group::setOthers(const uint8_t level) const
+{
+    for(uint8_t i = _first + 1; i < _count; i++) {
+        if(_selected & (1 << i))
+            digitalWrite(_chipSelects[i], level);
+    }
+}
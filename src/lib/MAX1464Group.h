@@ -0,0 +1,94 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464GROUP_H
+#define MAX1464GROUP_H
+
+#include "AbstractMAX1464.h"
+
+/**
+ * @brief Maximum number of devices in a MAX1464Group.
+ */
+#define MAX1464_GROUP_SIZE 8
+
+/**
+ * @brief Several %MAX1464 devices sharing SCK and MOSI (and MISO), each with
+ * its own chip select.
+ *
+ * Writes are broadcast: the chip select lines of all the selected devices are
+ * asserted together, so that erasing, programming and configuring a whole
+ * fixture takes the same time as a single device. Reads go to one device at
+ * a time, chosen with setReadDevice().
+ *
+ * The group is an AbstractMAX1464, thus every operation, including
+ * beginWritingToFlashPartition(), writeHexLineToFlashMemory() and the
+ * FlashProgrammer, works on all the selected devices at once:
+ * \code
+ * MAX1464 bus(10);
+ * MAX1464Group fixture(bus, 10);
+ * fixture.addDevice(9);
+ * fixture.addDevice(8);
+ * fixture.begin();
+ * fixture.beginWritingToFlashPartition(PARTITION_0);
+ * fixture.writeHexLineToFlashMemory(line);  // for every line
+ * fixture.setReadDevice(1);
+ * fixture.readFlashPartition();
+ * \endcode
+ *
+ * The bus driver only carries out the transfers; it must not be used
+ * directly while the group is in use. Its register cache is invalidated by
+ * every group transfer, and its chip select is restored by end().
+ */
+
+class MAX1464Group : public AbstractMAX1464
+{
+public:
+    MAX1464Group(AbstractMAX1464 &bus, const int chipSelect);
+    virtual void begin();
+    virtual void end();
+
+    int8_t addDevice(const int chipSelect);
+    uint8_t deviceCount() const { return _count; }
+    boolean selectDevices(const uint8_t mask);
+    void selectAll();
+    uint8_t selectedDevices() const { return _selected; }
+    void setReadDevice(const uint8_t index);
+    uint8_t readDevice() const { return _readDevice; }
+
+    virtual void byteShiftOut(
+            const uint8_t b, const char *debugMsg = NULL) const;
+    virtual uint16_t wordShiftIn() const;
+    virtual void bufferShiftOut(const uint8_t *buf, const uint8_t len) const;
+
+private:
+    void setOthers(const uint8_t level) const;
+
+    AbstractMAX1464 &_bus;
+    int _busChipSelect;    // restored by end()
+    int _chipSelects[MAX1464_GROUP_SIZE];
+    uint8_t _count;
+    uint8_t _selected;     // bit mask
+    uint8_t _first;        // lowest selected device, driven by the bus
+    uint8_t _readDevice;
+};
+
+#endif // MAX1464GROUP_H
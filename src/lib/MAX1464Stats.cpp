@@ -0,0 +1,112 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "MAX1464Core.h"
+
+#ifdef MAX1464_STATS
+
+static const char *operationNames[MAX1464Stats::OPERATIONS] = {
+    "writeByteToFlash",
+    "readModuleRegister",
+    "readCpuPort",
+    "eraseFlashPartition",
+    "readFlashPartition",
+};
+
+/**
+ * @brief Reset all the counters.
+ */
+
+void MAX1464Stats::clear()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+/**
+ * @brief Add an operation to its histogram.
+ * @param op
+ * @param us duration
+ */
+
+void MAX1464Stats::record(const Operation op, const unsigned long us)
+{
+    uint16_t &n = histograms[op][bucket(us)];
+    if(n != 0xffff)
+        n++;
+}
+
+/**
+ * @brief Histogram bucket of a duration.
+ * @param us
+ */
+
+uint8_t MAX1464Stats::bucket(const unsigned long us)
+{
+    uint8_t b = 0;
+    for(unsigned long t = us; t != 0 && b < MAX1464_STATS_BUCKETS - 1; t >>= 1)
+        b++;
+    return b;
+}
+
+/**
+ * @brief Print the counters and the non-empty histograms.
+ * @param out
+ *
+ * Histogram buckets are printed as "<upper bound in us>:<count>".
+ */
+
+void MAX1464Stats::print(Print &out) const
+{
+    out.print("bytes out ");
+    out.println(bytesOut);
+    out.print("words in ");
+    out.println(wordsIn);
+    out.print("transactions ");
+    out.println(transactions);
+    out.print("delay us ");
+    out.println(delayMicros);
+    for(uint8_t op = 0; op < OPERATIONS; op++) {
+        boolean empty = true;
+        for(uint8_t b = 0; b < MAX1464_STATS_BUCKETS; b++)
+            empty &= histograms[op][b] == 0;
+        if(empty)
+            continue;
+        out.print(operationNames[op]);
+        for(uint8_t b = 0; b < MAX1464_STATS_BUCKETS; b++) {
+            if(histograms[op][b] == 0)
+                continue;
+            out.print(' ');
+            if(b == MAX1464_STATS_BUCKETS - 1) {
+                out.print('>');
+                out.print((1UL << (b - 1)) - 1);
+            }
+            else {
+                out.print(b == 0 ? 0UL : (1UL << b) - 1);
+            }
+            out.print(':');
+            out.print(histograms[op][b]);
+        }
+        out.println();
+    }
+}
+
+#endif // MAX1464_STATS
@@ -0,0 +1,90 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464STATS_H
+#define MAX1464STATS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Number of buckets of the latency histograms of MAX1464Stats.
+ *
+ * Bucket 0 counts the operations that took less than 1 us, bucket i > 0 those
+ * that took from 2^(i-1) to 2^i - 1 us; the last bucket also counts all the
+ * slower ones.
+ */
+#define MAX1464_STATS_BUCKETS 16
+
+/**
+ * @brief Performance counters of a %MAX1464 object.
+ *
+ * Enabled by defining MAX1464_STATS, see MAX1464Core::stats().
+ */
+
+struct MAX1464Stats
+{
+    /**
+     * @brief Operations with a latency histogram.
+     */
+    enum Operation {
+        WRITE_BYTE_TO_FLASH,
+        READ_MODULE_REGISTER,
+        READ_CPU_PORT,
+        ERASE_FLASH_PARTITION,
+        READ_FLASH_PARTITION,
+        OPERATIONS,
+    };
+
+    unsigned long bytesOut;      ///< bytes shifted out
+    unsigned long wordsIn;       ///< words shifted in
+    unsigned long transactions;  ///< bus transfers
+    unsigned long delayMicros;   ///< time spent in delay()/delayMicroseconds()
+    /**
+     * @brief Latency histograms, saturating at 65535.
+     */
+    uint16_t histograms[OPERATIONS][MAX1464_STATS_BUCKETS];
+
+    void clear();
+    void record(const Operation op, const unsigned long us);
+    static uint8_t bucket(const unsigned long us);
+    void print(Print &out) const;
+};
+
+/**
+ * @brief Record the duration of an operation, from construction to
+ * destruction.
+ */
+
+class MAX1464StatsScope
+{
+public:
+    MAX1464StatsScope(MAX1464Stats &stats, const MAX1464Stats::Operation op) :
+        _stats(stats), _op(op), _start(micros()) {}
+    ~MAX1464StatsScope() { _stats.record(_op, micros() - _start); }
+
+private:
+    MAX1464Stats &_stats;
+    const MAX1464Stats::Operation _op;
+    const unsigned long _start;
+};
+
+#endif // MAX1464STATS_H
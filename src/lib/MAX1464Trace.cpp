@@ -0,0 +1,109 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "MAX1464Core.h"
+
+#ifdef MAX1464_TRACE
+
+using namespace MAX1464_enums;
+
+MAX1464TraceEvent MAX1464Trace::_events[MAX1464_TRACE_SIZE];
+uint8_t MAX1464Trace::_head = 0;
+uint8_t MAX1464Trace::_count = 0;
+unsigned long MAX1464Trace::_dropped = 0;
+
+/**
+ * @brief Discard all the events.
+ */
+
+void MAX1464Trace::clear()
+{
+    _head = 0;
+    _count = 0;
+    _dropped = 0;
+}
+
+/**
+ * @brief An event, 0 being the oldest.
+ * @param i must be less than count()
+ */
+
+const MAX1464TraceEvent &MAX1464Trace::event(const uint8_t i)
+{
+    return _events[(_head - _count + i) & (MAX1464_TRACE_SIZE - 1)];
+}
+
+/**
+ * @brief Print all the events, oldest first.
+ * @param out
+ */
+
+void MAX1464Trace::print(Print &out)
+{
+    if(_dropped) {
+        out.print(_dropped);
+        out.println(" events dropped");
+    }
+    for(uint8_t i = 0; i < _count; i++)
+        printEvent(event(i), out);
+}
+
+/**
+ * @brief Print an event on a line.
+ * @param event
+ * @param out
+ *
+ * Writes are printed as the time stamp, "W", the IRSA name and either the CR
+ * name or the nibble in hex; reads as the time stamp, "R" and the word in hex.
+ */
+
+void MAX1464Trace::printEvent(const MAX1464TraceEvent &event, Print &out)
+{
+    out.print(event.timestamp);
+    if(event.type == MAX1464TraceEvent::READ) {
+        out.print(" R 0x");
+        for(int8_t shift = 12; shift >= 0; shift -= 4)
+            out.print((event.value >> shift) & 0xf, HEX);
+        out.println();
+        return;
+    }
+    const uint8_t nibble = event.code >> 4;
+    const uint8_t irsa = event.code & 0xf;
+    out.print(" W ");
+    if(irsa <= IRSA_IMR) {
+        out.print(irsa_debug_msgs[irsa]);
+    }
+    else {
+        out.print("IRSA 0x");
+        out.print(irsa, HEX);
+    }
+    if(irsa == IRSA_CR) {
+        out.print(' ');
+        out.println(cr_commands_debug_msgs[nibble]);
+    }
+    else {
+        out.print(" 0x");
+        out.println(nibble, HEX);
+    }
+}
+
+#endif // MAX1464_TRACE
@@ -0,0 +1,143 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464TRACE_H
+#define MAX1464TRACE_H
+
+#include <Arduino.h>
+
+#ifndef MAX1464_TRACE_SIZE
+/**
+ * @brief Number of events kept by MAX1464Trace.
+ *
+ * Must be a power of two, not larger than 128.
+ */
+#define MAX1464_TRACE_SIZE 32
+#endif
+
+#if (MAX1464_TRACE_SIZE & (MAX1464_TRACE_SIZE - 1)) != 0 \
+    || MAX1464_TRACE_SIZE > 128
+#error "MAX1464_TRACE_SIZE must be a power of two not larger than 128"
+#endif
+
+/**
+ * @brief A bus event recorded by MAX1464Trace.
+ */
+
+struct MAX1464TraceEvent
+{
+    enum Type {
+        WRITE,  ///< nibble write, see code
+        READ,   ///< word read, see value
+    };
+
+    unsigned long timestamp;  ///< micros() when the event was recorded
+    uint8_t type;
+    uint8_t code;             ///< (nibble << 4) | IRSA, for writes
+    uint16_t value;           ///< word read, for reads
+};
+
+/**
+ * @brief Binary trace of the bus traffic of all the %MAX1464 objects.
+ *
+ * Enabled by defining MAX1464_TRACE. Each nibble write and word read goes
+ * through the trace, which keeps the last MAX1464_TRACE_SIZE events in RAM,
+ * without printing anything, so that the timing of the bus is preserved. The
+ * events can be printed afterwards with print(), which decodes them into the
+ * IRSA and CR names:
+ * \code
+ * #define MAX1464_TRACE  // in MAX1464Core.h, or from the compiler flags
+ * ...
+ * MAX1464Trace::clear();
+ * max1464.readModuleRegister(R_ADC_DATA_1);
+ * MAX1464Trace::print(Serial);
+ * \endcode
+ *
+ * Writes are recorded when they are handed to the bus: batched writes are
+ * recorded at the flush, one event per byte, all with the time of the flush.
+ * Bytes that the bus classes send on their own, such as the IMR writes of
+ * 3-wire reads, are not recorded.
+ */
+
+class MAX1464Trace
+{
+public:
+    static void recordWrite(const uint8_t code);
+    static void recordRead(const uint16_t value);
+
+    static void clear();
+    static uint8_t count() { return _count; }
+    static const MAX1464TraceEvent &event(const uint8_t i);
+    static unsigned long dropped() { return _dropped; }
+
+    static void print(Print &out);
+    static void printEvent(const MAX1464TraceEvent &event, Print &out);
+
+private:
+    static MAX1464TraceEvent &next();
+
+    static MAX1464TraceEvent _events[MAX1464_TRACE_SIZE];
+    static uint8_t _head, _count;
+    static unsigned long _dropped;
+};
+
+
+
+inline MAX1464TraceEvent &MAX1464Trace::next()
+{
+    MAX1464TraceEvent &e = _events[_head];
+    _head = (_head + 1) & (MAX1464_TRACE_SIZE - 1);
+    if(_count == MAX1464_TRACE_SIZE)
+        _dropped++;
+    else
+        _count++;
+    e.timestamp = micros();
+    return e;
+}
+
+/**
+ * @brief Record a nibble write.
+ * @param code the byte sent, (nibble << 4) | IRSA
+ */
+
+inline void MAX1464Trace::recordWrite(const uint8_t code)
+{
+    MAX1464TraceEvent &e = next();
+    e.type = MAX1464TraceEvent::WRITE;
+    e.code = code;
+    e.value = 0;
+}
+
+/**
+ * @brief Record a word read.
+ * @param value
+ */
+
+inline void MAX1464Trace::recordRead(const uint16_t value)
+{
+    MAX1464TraceEvent &e = next();
+    e.type = MAX1464TraceEvent::READ;
+    e.code = 0;
+    e.value = value;
+}
+
+#endif // MAX1464TRACE_H
@@ -180,23 +180,23 @@ enum ADC_CONTROL {
  */
 
 enum PGA {
-    CONFIGA_PGA_00, CONFIGA_PGA_GAIN_0_99   = 0x0000,
-    CONFIGA_PGA_01, CONFIGA_PGA_GAIN_7_7    = 0x0800,
-    CONFIGA_PGA_02, CONFIGA_PGA_GAIN_15_5   = 0x1000,
-    CONFIGA_PGA_03, CONFIGA_PGA_GAIN_23     = 0x1800,
-    CONFIGA_PGA_04, CONFIGA_PGA_GAIN_31     = 0x2000,
-    CONFIGA_PGA_05, CONFIGA_PGA_GAIN_39     = 0x2800,
-    CONFIGA_PGA_06, CONFIGA_PGA_GAIN_46     = 0x3000,
-    CONFIGA_PGA_07, CONFIGA_PGA_GAIN_54     = 0x3800,
-    CONFIGA_PGA_08, CONFIGA_PGA_GAIN_65     = 0x4000,
-    CONFIGA_PGA_0A, CONFIGA_PGA_GAIN_77     = 0x5000,
-    CONFIGA_PGA_0C, CONFIGA_PGA_GAIN_92     = 0x6000,
-    CONFIGA_PGA_0E, CONFIGA_PGA_GAIN_107    = 0x7000,
-    CONFIGA_PGA_10, CONFIGA_PGA_GAIN_123    = 0x8000,
-    CONFIGA_PGA_14, CONFIGA_PGA_GAIN_153    = 0xa000,
-    CONFIGA_PGA_18, CONFIGA_PGA_GAIN_183    = 0xc000,
-    CONFIGA_PGA_1C, CONFIGA_PGA_GAIN_214    = 0xe000,
-    CONFIGA_PGA_1E, CONFIGA_PGA_GAIN_244    = 0xf000,
+    CONFIGA_PGA_00 = 0x0000, CONFIGA_PGA_GAIN_0_99   = CONFIGA_PGA_00,
+    CONFIGA_PGA_01 = 0x0800, CONFIGA_PGA_GAIN_7_7    = CONFIGA_PGA_01,
+    CONFIGA_PGA_02 = 0x1000, CONFIGA_PGA_GAIN_15_5   = CONFIGA_PGA_02,
+    CONFIGA_PGA_03 = 0x1800, CONFIGA_PGA_GAIN_23     = CONFIGA_PGA_03,
+    CONFIGA_PGA_04 = 0x2000, CONFIGA_PGA_GAIN_31     = CONFIGA_PGA_04,
+    CONFIGA_PGA_05 = 0x2800, CONFIGA_PGA_GAIN_39     = CONFIGA_PGA_05,
+    CONFIGA_PGA_06 = 0x3000, CONFIGA_PGA_GAIN_46     = CONFIGA_PGA_06,
+    CONFIGA_PGA_07 = 0x3800, CONFIGA_PGA_GAIN_54     = CONFIGA_PGA_07,
+    CONFIGA_PGA_08 = 0x4000, CONFIGA_PGA_GAIN_65     = CONFIGA_PGA_08,
+    CONFIGA_PGA_0A = 0x5000, CONFIGA_PGA_GAIN_77     = CONFIGA_PGA_0A,
+    CONFIGA_PGA_0C = 0x6000, CONFIGA_PGA_GAIN_92     = CONFIGA_PGA_0C,
+    CONFIGA_PGA_0E = 0x7000, CONFIGA_PGA_GAIN_107    = CONFIGA_PGA_0E,
+    CONFIGA_PGA_10 = 0x8000, CONFIGA_PGA_GAIN_123    = CONFIGA_PGA_10,
+    CONFIGA_PGA_14 = 0xa000, CONFIGA_PGA_GAIN_153    = CONFIGA_PGA_14,
+    CONFIGA_PGA_18 = 0xc000, CONFIGA_PGA_GAIN_183    = CONFIGA_PGA_18,
+    CONFIGA_PGA_1C = 0xe000, CONFIGA_PGA_GAIN_214    = CONFIGA_PGA_1C,
+    CONFIGA_PGA_1E = 0xf000, CONFIGA_PGA_GAIN_244    = CONFIGA_PGA_1E,
 };
 
 /**
@@ -204,14 +204,14 @@ enum PGA {
  */
 
 enum ADC_CLK {
-    CONFIGA_CLK0, CONFIGA_CLK_1MHz      = 0x0000,
-    CONFIGA_CLK1, CONFIGA_CLK_500kHz	= 0x0100,
-    CONFIGA_CLK2, CONFIGA_CLK_250kHz	= 0x0200,
-    CONFIGA_CLK3, CONFIGA_CLK_125kHz	= 0x0300,
-    CONFIGA_CLK4, CONFIGA_CLK_62_5kHz	= 0x0400,
-    CONFIGA_CLK5, CONFIGA_CLK_31_25kHz	= 0x0500,
-    CONFIGA_CLK6, CONFIGA_CLK_15_625kHz	= 0x0600,
-    CONFIGA_CLK7, CONFIGA_CLK_7_8125kHz = 0x0700,
+    CONFIGA_CLK0 = 0x0000, CONFIGA_CLK_1MHz      = CONFIGA_CLK0,
+    CONFIGA_CLK1 = 0x0100, CONFIGA_CLK_500kHz    = CONFIGA_CLK1,
+    CONFIGA_CLK2 = 0x0200, CONFIGA_CLK_250kHz    = CONFIGA_CLK2,
+    CONFIGA_CLK3 = 0x0300, CONFIGA_CLK_125kHz    = CONFIGA_CLK3,
+    CONFIGA_CLK4 = 0x0400, CONFIGA_CLK_62_5kHz   = CONFIGA_CLK4,
+    CONFIGA_CLK5 = 0x0500, CONFIGA_CLK_31_25kHz  = CONFIGA_CLK5,
+    CONFIGA_CLK6 = 0x0600, CONFIGA_CLK_15_625kHz = CONFIGA_CLK6,
+    CONFIGA_CLK7 = 0x0700, CONFIGA_CLK_7_8125kHz = CONFIGA_CLK7,
 };
 
 /**
@@ -219,13 +219,13 @@ enum ADC_CLK {
  */
 
 enum ADC_RES {
-    CONFIGA_RES0, CONFIGA_RES_9BIT  = 0x0000,
-    CONFIGA_RES1, CONFIGA_RES_10BIT = 0x0010,
-    CONFIGA_RES2, CONFIGA_RES_12BIT = 0x0020,
-    CONFIGA_RES3, CONFIGA_RES_13BIT = 0x0030,
-    CONFIGA_RES4, CONFIGA_RES_14BIT = 0x0040,
-    CONFIGA_RES5, CONFIGA_RES_15BIT = 0x0050,
-    CONFIGA_RES6, CONFIGA_RES_16BIT = 0x0060,
+    CONFIGA_RES0 = 0x0000, CONFIGA_RES_9BIT  = CONFIGA_RES0,
+    CONFIGA_RES1 = 0x0010, CONFIGA_RES_10BIT = CONFIGA_RES1,
+    CONFIGA_RES2 = 0x0020, CONFIGA_RES_12BIT = CONFIGA_RES2,
+    CONFIGA_RES3 = 0x0030, CONFIGA_RES_13BIT = CONFIGA_RES3,
+    CONFIGA_RES4 = 0x0040, CONFIGA_RES_14BIT = CONFIGA_RES4,
+    CONFIGA_RES5 = 0x0050, CONFIGA_RES_15BIT = CONFIGA_RES5,
+    CONFIGA_RES6 = 0x0060, CONFIGA_RES_16BIT = CONFIGA_RES6,
 };
 
 /**
@@ -256,14 +256,14 @@ enum ADC_COARSE_OFFSET {
  */
 
 enum ADC_BIAS_CURRENT {
-    CONFIGB_BIAS0, CONFIGB_BIAS_1_8 = 0x0000,
-    CONFIGB_BIAS1, CONFIGB_BIAS_2_8 = 0x0010,
-    CONFIGB_BIAS2, CONFIGB_BIAS_3_8 = 0x0020,
-    CONFIGB_BIAS3, CONFIGB_BIAS_4_8 = 0x0030,
-    CONFIGB_BIAS4, CONFIGB_BIAS_5_8 = 0x0040,
-    CONFIGB_BIAS5, CONFIGB_BIAS_6_8 = 0x0050,
-    CONFIGB_BIAS6, CONFIGB_BIAS_7_8 = 0x0060,
-    CONFIGB_BIAS7, CONFIGB_BIAS_8_8 = 0x0070,
+    CONFIGB_BIAS0 = 0x0000, CONFIGB_BIAS_1_8 = CONFIGB_BIAS0,
+    CONFIGB_BIAS1 = 0x0010, CONFIGB_BIAS_2_8 = CONFIGB_BIAS1,
+    CONFIGB_BIAS2 = 0x0020, CONFIGB_BIAS_3_8 = CONFIGB_BIAS2,
+    CONFIGB_BIAS3 = 0x0030, CONFIGB_BIAS_4_8 = CONFIGB_BIAS3,
+    CONFIGB_BIAS4 = 0x0040, CONFIGB_BIAS_5_8 = CONFIGB_BIAS4,
+    CONFIGB_BIAS5 = 0x0050, CONFIGB_BIAS_6_8 = CONFIGB_BIAS5,
+    CONFIGB_BIAS6 = 0x0060, CONFIGB_BIAS_7_8 = CONFIGB_BIAS6,
+    CONFIGB_BIAS7 = 0x0070, CONFIGB_BIAS_8_8 = CONFIGB_BIAS7,
 };
 
 /**
@@ -271,9 +271,9 @@ enum ADC_BIAS_CURRENT {
  */
 
 enum ADC_REF_SOURCE {
-    CONFIGB_REF0, CONFIGB_REF_VDD   = 0x0000,
-    CONFIGB_REF1, CONFIGB_REF_2VREF = 0x0001,
-    CONFIGB_REF2, CONFIGB_REF_4VBG  = 0x0002,
+    CONFIGB_REF0 = 0x0000, CONFIGB_REF_VDD   = CONFIGB_REF0,
+    CONFIGB_REF1 = 0x0001, CONFIGB_REF_2VREF = CONFIGB_REF1,
+    CONFIGB_REF2 = 0x0002, CONFIGB_REF_4VBG  = CONFIGB_REF2,
 };
 
 
@@ -0,0 +1,253 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MAX1464_REGISTERS_H
+#define MAX1464_REGISTERS_H
+
+#include <stdint.h>
+#include "MAX1464_enums.h"
+
+/**
+ * \brief Typed builders for the module configuration registers.
+ *
+ * Each builder wraps the value of one register. Fields are set with chained
+ * calls, which only accept the enum of that field, so that bits of another
+ * field or register cannot be mixed in. Numeric fields are template
+ * arguments, checked at compile time. Builders are constexpr and fold to a
+ * single constant:
+ * \code
+ * using namespace MAX1464_registers;
+ * max1464.writeModuleRegister(
+ *             AdcConfigA().pga(CONFIGA_PGA_GAIN_31).clock(CONFIGA_CLK_1MHz)
+ *             .resolution(CONFIGA_RES_16BIT).coarseOffset(CONFIGA_CO0),
+ *             R_ADC_CONFIG_1A);
+ * max1464.writeModuleRegister(TmrConfig().prescaler<32>().count<625>(),
+ *                             R_TMR_CONFIG);
+ * \endcode
+ *
+ * A builder can also start from a known register value, e.g. the shadow copy
+ * of a ModuleRegisterBank, to change a single field without reading the
+ * device:
+ * \code
+ * uint16_t config;
+ * if(bank.value(R_ADC_CONFIG_1A, config))
+ *     bank.write(AdcConfigA(config).resolution(CONFIGA_RES_12BIT),
+ *                R_ADC_CONFIG_1A);
+ * \endcode
+ */
+
+namespace MAX1464_registers {
+
+
+/**
+ * @brief ADC_CONFIG_nA register.
+ */
+
+class AdcConfigA
+{
+public:
+    static const uint16_t PGA_MASK = 0xf800;
+    static const uint16_t CLK_MASK = 0x0700;
+    static const uint16_t RES_MASK = 0x0070;
+    static const uint16_t CO_MASK  = 0x000f;
+
+    constexpr explicit AdcConfigA(const uint16_t value = 0) : _value(value) {}
+    constexpr operator uint16_t() const { return _value; }
+
+    constexpr AdcConfigA pga(const MAX1464_enums::PGA pga) const {
+        return AdcConfigA((_value & ~PGA_MASK) | pga);
+    }
+    constexpr AdcConfigA clock(const MAX1464_enums::ADC_CLK clk) const {
+        return AdcConfigA((_value & ~CLK_MASK) | clk);
+    }
+    constexpr AdcConfigA resolution(const MAX1464_enums::ADC_RES res) const {
+        return AdcConfigA((_value & ~RES_MASK) | res);
+    }
+    constexpr AdcConfigA coarseOffset(
+            const MAX1464_enums::ADC_COARSE_OFFSET co) const {
+        return AdcConfigA((_value & ~CO_MASK) | co);
+    }
+
+private:
+    uint16_t _value;
+};
+
+/**
+ * @brief ADC_CONFIG_nB register.
+ */
+
+class AdcConfigB
+{
+public:
+    static const uint16_t BIAS_MASK = 0x0070;
+    static const uint16_t REF_MASK  = 0x0003;
+
+    constexpr explicit AdcConfigB(const uint16_t value = 0) : _value(value) {}
+    constexpr operator uint16_t() const { return _value; }
+
+    constexpr AdcConfigB bias(
+            const MAX1464_enums::ADC_BIAS_CURRENT bias) const {
+        return AdcConfigB((_value & ~BIAS_MASK) | bias);
+    }
+    constexpr AdcConfigB reference(
+            const MAX1464_enums::ADC_REF_SOURCE ref) const {
+        return AdcConfigB((_value & ~REF_MASK) | ref);
+    }
+
+private:
+    uint16_t _value;
+};
+
+/**
+ * @brief DOPn_CONTROL register.
+ */
+
+class DopControl
+{
+public:
+    constexpr explicit DopControl(const uint16_t value = 0) : _value(value) {}
+    constexpr operator uint16_t() const { return _value; }
+
+    constexpr DopControl pwm(const bool enable) const {
+        return DopControl(set(MAX1464_enums::DOP_CONTROL_ENPWM, enable));
+    }
+    constexpr DopControl dac(const bool enable) const {
+        return DopControl(set(MAX1464_enums::DOP_CONTROL_ENDAC, enable));
+    }
+
+private:
+    constexpr uint16_t set(const uint16_t bit, const bool enable) const {
+        return enable ? _value | bit : _value & ~bit;
+    }
+
+    uint16_t _value;
+};
+
+/**
+ * @brief DOPn_CONFIG register.
+ */
+
+class DopConfig
+{
+public:
+    constexpr explicit DopConfig(const uint16_t value = 0) : _value(value) {}
+    constexpr operator uint16_t() const { return _value; }
+
+    constexpr DopConfig pwmLowGain(const bool enable) const {
+        return DopConfig(set(MAX1464_enums::DOP_CONFIG_PWMLG, enable));
+    }
+    constexpr DopConfig dacLowGain(const bool enable) const {
+        return DopConfig(set(MAX1464_enums::DOP_CONFIG_DACLG, enable));
+    }
+    constexpr DopConfig reference(const bool enable) const {
+        return DopConfig(set(MAX1464_enums::DOP_CONFIG_REF, enable));
+    }
+
+private:
+    constexpr uint16_t set(const uint16_t bit, const bool enable) const {
+        return enable ? _value | bit : _value & ~bit;
+    }
+
+    uint16_t _value;
+};
+
+/**
+ * @brief TMR_CONFIG register.
+ *
+ * The timer period is (count + 1) * prescaler * 500 ns.
+ */
+
+class TmrConfig
+{
+public:
+    static const uint16_t PS_MASK    = 0xf000;
+    static const uint16_t COUNT_MASK = 0x0fff;
+
+    constexpr explicit TmrConfig(const uint16_t value = 0) : _value(value) {}
+    constexpr operator uint16_t() const { return _value; }
+
+    /**
+     * @brief Set the prescaler: 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96,
+     * 128, 192 or 384.
+     */
+    template <unsigned ps>
+    constexpr TmrConfig prescaler() const {
+        static_assert(prescalerCode(ps) != 0xff, "invalid timer prescaler");
+        return TmrConfig((_value & ~PS_MASK) | (prescalerCode(ps) << 12));
+    }
+    /**
+     * @brief Set the timer count, 0 to 4095.
+     */
+    template <unsigned n>
+    constexpr TmrConfig count() const {
+        static_assert(n <= COUNT_MASK, "timer count out of range");
+        return TmrConfig((_value & ~COUNT_MASK) | n);
+    }
+
+private:
+    static constexpr uint8_t prescalerCode(const unsigned ps) {
+        return ps == 1 ? 0x0 : ps == 3 ? 0x1 : ps == 2 ? 0x2 : ps == 6 ? 0x3
+             : ps == 4 ? 0x4 : ps == 12 ? 0x5 : ps == 8 ? 0x6 : ps == 24 ? 0x7
+             : ps == 16 ? 0x8 : ps == 48 ? 0x9 : ps == 32 ? 0xa
+             : ps == 96 ? 0xb : ps == 64 ? 0xc : ps == 192 ? 0xd
+             : ps == 128 ? 0xe : ps == 384 ? 0xf : 0xff;
+    }
+
+    uint16_t _value;
+};
+
+/**
+ * @brief OSC_CONTROL register.
+ */
+
+class OscControl
+{
+public:
+    static const uint16_t TRIM_MASK = 0x1f00;
+
+    constexpr explicit OscControl(const uint16_t value = 0) : _value(value) {}
+    constexpr operator uint16_t() const { return _value; }
+
+    constexpr OscControl trim(const MAX1464_enums::OSC_CONTROL trim) const {
+        return OscControl((_value & ~TRIM_MASK) | (trim & TRIM_MASK));
+    }
+    /**
+     * @brief Set the frequency trim, -16 to 15.
+     */
+    template <int steps>
+    constexpr OscControl trim() const {
+        static_assert(steps >= -16 && steps <= 15, "trim out of range");
+        return OscControl((_value & ~TRIM_MASK)
+                          | ((steps >= 0 ? steps : 0x0f - steps) << 8));
+    }
+    constexpr OscControl clockOutput(const bool enable) const {
+        return OscControl(enable ? _value | MAX1464_enums::OSC_ENCKOUT
+                                 : _value & ~MAX1464_enums::OSC_ENCKOUT);
+    }
+
+private:
+    uint16_t _value;
+};
+
+}  // namespace
+
+#endif // MAX1464_REGISTERS_H
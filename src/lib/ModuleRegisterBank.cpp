@@ -0,0 +1,161 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#include "ModuleRegisterBank.h"
+
+using namespace MAX1464_enums;
+
+static const uint8_t addresses[MAX1464_CONFIG_REGISTERS] = {
+    R_ADC_CONFIG_1A, R_ADC_CONFIG_1B,
+    R_ADC_CONFIG_2A, R_ADC_CONFIG_2B,
+    R_ADC_CONFIG_TA, R_ADC_CONFIG_TB,
+    R_DOP1_DATA, R_DOP1_CONTROL, R_DOP1_CONFIG,
+    R_DOP2_DATA, R_DOP2_CONTROL, R_DOP2_CONFIG,
+    R_TMR_CONTROL, R_TMR_CONFIG,
+    R_OPAMP_CONFIG, R_PO_CONTROL, R_OSC_CONTROL,
+    R_GPIO1_CONTROL, R_GPIO2_CONTROL,
+};
+
+ModuleRegisterBank::ModuleRegisterBank(const AbstractMAX1464 &max1464) :
+    _max1464(max1464)
+{
+    _shadowValid = false;
+}
+
+/**
+ * @brief Read all the configuration registers.
+ * @param snapshot
+ *
+ * The shadow copy is updated.
+ */
+
+void ModuleRegisterBank::readAll(MAX1464RegisterSnapshot &snapshot)
+{
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++)
+        snapshot.values[i] = _max1464.readModuleRegister(address(i));
+    _shadow = snapshot;
+    _shadowValid = true;
+}
+
+/**
+ * @brief Write the registers of a snapshot that differ from the shadow copy.
+ * @param snapshot
+ * @return the number of registers written
+ *
+ * If the shadow copy is not valid, all the registers are written. The writes
+ * are sent in a single batch.
+ */
+
+uint8_t ModuleRegisterBank::restore(const MAX1464RegisterSnapshot &snapshot)
+{
+    uint8_t n = 0;
+    _max1464.beginBatch();
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++) {
+        if(_shadowValid && _shadow.values[i] == snapshot.values[i])
+            continue;
+        _max1464.writeModuleRegister(snapshot.values[i], address(i));
+        n++;
+    }
+    _max1464.endBatch();
+    _shadow = snapshot;
+    _shadowValid = true;
+    return n;
+}
+
+/**
+ * @brief Value of a register in the shadow copy.
+ * @param addr
+ * @param out set to the value, left unchanged otherwise
+ * @return false if the shadow copy is not valid or the register is not part
+ * of a snapshot
+ *
+ * Together with the builders of MAX1464_registers, allows changing a field
+ * without reading the register from the device.
+ */
+
+boolean ModuleRegisterBank::value(const MODULE_REGISTER_ADDRESS addr,
+                                  uint16_t &out) const
+{
+    const int8_t i = indexOf(addr);
+    if(!_shadowValid || i < 0)
+        return false;
+    out = _shadow.values[i];
+    return true;
+}
+
+/**
+ * @brief Write a register, unless the shadow copy says it already holds the
+ * value.
+ * @param data
+ * @param addr
+ * @return true if the register was written
+ */
+
+boolean ModuleRegisterBank::write(const uint16_t data,
+                                  const MODULE_REGISTER_ADDRESS addr)
+{
+    const int8_t i = indexOf(addr);
+    if(i >= 0 && _shadowValid) {
+        if(_shadow.values[i] == data)
+            return false;
+        _shadow.values[i] = data;
+    }
+    _max1464.writeModuleRegister(data, addr);
+    return true;
+}
+
+/**
+ * @brief Forget the shadow copy.
+ *
+ * Call this function when the registers may have been changed without going
+ * through the bank, e.g. by the firmware or by writeModuleRegister().
+ */
+
+void ModuleRegisterBank::invalidate()
+{
+    _shadowValid = false;
+}
+
+/**
+ * @brief Address of the i-th register of a snapshot.
+ * @param i
+ */
+
+MODULE_REGISTER_ADDRESS ModuleRegisterBank::address(const uint8_t i)
+{
+    return (MODULE_REGISTER_ADDRESS)addresses[i];
+}
+
+/**
+ * @brief Position of a register in a snapshot.
+ * @param addr
+ * @return -1 if the register is not part of a snapshot
+ */
+
+int8_t ModuleRegisterBank::indexOf(const MODULE_REGISTER_ADDRESS addr)
+{
+    for(uint8_t i = 0; i < MAX1464_CONFIG_REGISTERS; i++) {
+        if(addresses[i] == addr)
+            return i;
+    }
+    return -1;
+}
@@ -0,0 +1,93 @@
+/*
+  MAX1464 library for Arduino
+  Copyright (C) 2016 Giacomo Mazzamuto <gmazzamuto@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * \file
+ */
+
+#ifndef MODULEREGISTERBANK_H
+#define MODULEREGISTERBANK_H
+
+#include "AbstractMAX1464.h"
+#include "MAX1464_registers.h"
+
+/**
+ * @brief Number of configuration module registers, see ModuleRegisterBank.
+ */
+#define MAX1464_CONFIG_REGISTERS 19
+
+/**
+ * @brief Values of all the configuration module registers.
+ *
+ * The order is that of ModuleRegisterBank::address().
+ */
+
+struct MAX1464RegisterSnapshot
+{
+    uint16_t values[MAX1464_CONFIG_REGISTERS];
+};
+
+/**
+ * @brief Save and restore the analog configuration.
+ *
+ * A snapshot covers the configuration module registers: ADC_CONFIG_*, DOPn_*,
+ * TMR_*, OPAMP_CONFIG, PO_CONTROL, OSC_CONTROL and GPIOn_CONTROL. ADC_CONTROL
+ * and the ADC_DATA_* registers are left out, as writing them starts a
+ * conversion or has no effect.
+ *
+ * The bank keeps a shadow copy of what the device contains, as last read or
+ * written through it, so that restore() only writes the registers that
+ * differ. Switching between sensor profiles thus costs one write per
+ * register that actually changes:
+ * \code
+ * ModuleRegisterBank bank(max1464);
+ * MAX1464RegisterSnapshot profileA, profileB;
+ * bank.readAll(profileA);
+ * ... // configure for profile B
+ * bank.readAll(profileB);
+ * bank.restore(profileA);
+ * \endcode
+ *
+ * \pre CPU must be halted, so that it does not change the module registers.
+ */
+
+class ModuleRegisterBank
+{
+public:
+    ModuleRegisterBank(const AbstractMAX1464 &max1464);
+
+    void readAll(MAX1464RegisterSnapshot &snapshot);
+    uint8_t restore(const MAX1464RegisterSnapshot &snapshot);
+    boolean value(const MAX1464_enums::MODULE_REGISTER_ADDRESS addr,
+                  uint16_t &out) const;
+    boolean write(const uint16_t data,
+                  const MAX1464_enums::MODULE_REGISTER_ADDRESS addr);
+    void invalidate();
+    boolean isShadowValid() const { return _shadowValid; }
+    const MAX1464RegisterSnapshot &shadow() const { return _shadow; }
+
+    static MAX1464_enums::MODULE_REGISTER_ADDRESS address(const uint8_t i);
+    static int8_t indexOf(const MAX1464_enums::MODULE_REGISTER_ADDRESS addr);
+
+private:
+    const AbstractMAX1464 &_max1464;
+    MAX1464RegisterSnapshot _shadow;
+    boolean _shadowValid;
+};
+
+#endif // MODULEREGISTERBANK_H
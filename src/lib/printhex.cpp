@@ -45,3 +45,72 @@ void printHex16(const uint16_t word)
     Serial.print(w.lsb, HEX);
     Serial.print(" ");
 }
+
+static const char hexDigits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+static inline char *formatHexByte(char *p, const uint8_t b)
+{
+    *p++ = hexDigits[b >> 4];
+    *p++ = hexDigits[b & 0xf];
+    return p;
+}
+
+/**
+ * @brief Format an Intel HEX record
+ * @param buf destination, at least HEX_RECORD_BUFFER_SIZE(len) bytes long
+ * @param addr
+ * @param type record type
+ * @param data
+ * @param len number of data bytes
+ * @return the number of characters written, excluding the final NUL
+ *
+ * The record is terminated by CR LF, as with Serial.println().
+ */
+
+size_t formatHexRecord(char *buf, const uint16_t addr, const uint8_t type,
+                        const uint8_t *data, const uint8_t len)
+{
+    char *p = buf;
+    uint8_t checksum = len + (addr >> 8) + (addr & 0xff) + type;
+    *p++ = ':';
+    p = formatHexByte(p, len);
+    p = formatHexByte(p, addr >> 8);
+    p = formatHexByte(p, addr & 0xff);
+    p = formatHexByte(p, type);
+    for(uint8_t i = 0; i < len; i++) {
+        p = formatHexByte(p, data[i]);
+        checksum += data[i];
+    }
+    p = formatHexByte(p, ~checksum + 1);
+    *p++ = '\r';
+    *p++ = '\n';
+    *p = '\0';
+    return p - buf;
+}
+
+/**
+ * @brief Print an Intel HEX record
+ * @param out any Print object, e.g. Serial
+ * @param addr
+ * @param type record type
+ * @param data
+ * @param len number of data bytes, at most HEX_RECORD_PRINT_MAX_DATA
+ * @return false, without printing anything, if len is too large
+ *
+ * The whole line is formatted in a buffer and handed to out with a single
+ * write() call.
+ */
+
+boolean printHexRecord(Print &out, const uint16_t addr, const uint8_t type,
+                       const uint8_t *data, const uint8_t len)
+{
+    if(len > HEX_RECORD_PRINT_MAX_DATA)
+        return false;
+    char buf[HEX_RECORD_BUFFER_SIZE(HEX_RECORD_PRINT_MAX_DATA)];
+    out.write((const uint8_t *)buf,
+              formatHexRecord(buf, addr, type, data, len));
+    return true;
+}
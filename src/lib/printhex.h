@@ -28,4 +28,22 @@
 extern void printHex8(const uint8_t b);
 extern void printHex16(const uint16_t word);
 
+/**
+ * @brief Size of the buffer needed by formatHexRecord() for a record with len
+ * data bytes, including the line terminator and the final NUL.
+ */
+#define HEX_RECORD_BUFFER_SIZE(len) (11 + 2 * (len) + 3)
+
+/**
+ * @brief Maximum number of data bytes of a record printed by printHexRecord().
+ */
+#define HEX_RECORD_PRINT_MAX_DATA 16
+
+extern size_t formatHexRecord(char *buf, const uint16_t addr,
+                               const uint8_t type, const uint8_t *data,
+                               const uint8_t len);
+extern boolean printHexRecord(Print &out, const uint16_t addr,
+                              const uint8_t type, const uint8_t *data,
+                              const uint8_t len);
+
 #endif // PRINTHEX_H